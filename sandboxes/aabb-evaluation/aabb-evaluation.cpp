@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <algorithm>
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
@@ -90,6 +91,61 @@ void profile(const TriangleMesh &mesh)
                 occlusion_output0(ivertex) = (double)num_hits/(double)num_samples;
             }
         }
+
+        {
+            PROFILE_BLOCK(EigenMesh3D_AABBIndirectF_Packet_AmbientOcclusion);
+            occlusion_output0.resize(num_vertices, 1);
+            std::vector<Vec3f>    ray_origins;
+            std::vector<Vec3f>    ray_dirs;
+            std::vector<igl::Hit> hits;
+            for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
+                const Eigen::Vector3d origin = mesh.its.vertices[ivertex].template cast<double>();
+                const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
+                ray_origins.clear();
+                ray_dirs.clear();
+                for (int s = 0; s < num_samples; s++) {
+                    Eigen::Vector3d d = dirs.row(s);
+                    if(d.dot(normal) < 0) {
+                        // reverse ray
+                        d *= -1;
+                    }
+                    ray_origins.emplace_back((origin + 1e-4 * d).template cast<float>());
+                    ray_dirs.emplace_back(d.template cast<float>());
+                }
+                AABBTreeIndirect::intersect_rays_first_hit(mesh.its.vertices, mesh.its.indices, tree, ray_origins, ray_dirs, hits);
+                int num_hits = int(std::count_if(hits.begin(), hits.end(), [](const igl::Hit &hit) { return hit.id >= 0; }));
+                occlusion_output0(ivertex) = (double)num_hits/(double)num_samples;
+            }
+        }
+    }
+
+    Eigen::MatrixXd occlusion_output_wide;
+    {
+        AABBTreeIndirect::WideTree3f tree;
+        {
+            PROFILE_BLOCK(AABBIndirectWide_Init);
+            tree = AABBTreeIndirect::build_wide_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices);
+        }
+        {
+            PROFILE_BLOCK(EigenMesh3D_AABBIndirectWide_AmbientOcclusion);
+            occlusion_output_wide.resize(num_vertices, 1);
+            for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
+                const Eigen::Vector3d origin = mesh.its.vertices[ivertex].template cast<double>();
+                const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
+                int num_hits = 0;
+                for (int s = 0; s < num_samples; s++) {
+                    Eigen::Vector3d d = dirs.row(s);
+                    if(d.dot(normal) < 0) {
+                        // reverse ray
+                        d *= -1;
+                    }
+                    igl::Hit hit;
+                    if (AABBTreeIndirect::intersect_ray_first_hit(mesh.its.vertices, mesh.its.indices, tree, (origin + 1e-4 * d).eval(), d, hit))
+                        ++ num_hits;
+                }
+                occlusion_output_wide(ivertex) = (double)num_hits/(double)num_samples;
+            }
+        }
     }
 
     Eigen::MatrixXd occlusion_output1;
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/TriangleSelector.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+// Replays painting strokes over a mesh loaded from a file or over a finely tessellated sphere
+// and measures the time spent in TriangleSelector for each cursor move.
+// Usage: triangle_selector_stroke [mesh.stl]
+
+namespace Slic3r {
+
+static void replay_strokes(const TriangleMesh &mesh)
+{
+    const indexed_triangle_set &its = mesh.its;
+    const BoundingBoxf3         bbox = mesh.bounding_box();
+    const Transform3d           trafo = Transform3d::Identity();
+    const TriangleSelector::ClippingPlane clp;
+    const Vec3f                 camera_pos = (bbox.center() + Vec3d(0., 0., 10. * bbox.size().norm())).cast<float>();
+
+    std::cout << "Triangles: " << its.indices.size() << std::endl;
+
+    Benchmark b;
+    TriangleSelector selector(mesh);
+
+    // Height range cursor moved from the bottom to the top of the mesh, as done by the height range painting tool.
+    {
+        const int   num_steps = 100;
+        const float height    = float(bbox.size().z()) / num_steps;
+        double      t_max     = 0.;
+        b.start();
+        for (int i = 0; i < num_steps; ++ i) {
+            Benchmark bs;
+            bs.start();
+            float z = float(bbox.min.z()) + i * height;
+            selector.select_patch(0, TriangleSelector::SinglePointCursor::cursor_factory(z, camera_pos, height, trafo, clp),
+                (i & 1) ? EnforcerBlockerType::ENFORCER : EnforcerBlockerType::BLOCKER, trafo, true);
+            bs.stop();
+            t_max = std::max(t_max, bs.getElapsedSec());
+        }
+        b.stop();
+        std::cout << "Height range stroke: " << num_steps << " steps, total " << b.getElapsedSec() << " s, worst step " << t_max << " s" << std::endl;
+    }
+
+    // Sphere brush dragged around the mesh at its mid height.
+    {
+        const float z_mid = float(bbox.center().z());
+        std::vector<std::pair<float, int>> stroke;
+        for (int facet_idx = 0; facet_idx < int(its.indices.size()); ++ facet_idx) {
+            Vec3f c = (its.vertices[its.indices[facet_idx](0)] + its.vertices[its.indices[facet_idx](1)] + its.vertices[its.indices[facet_idx](2)]) / 3.f;
+            if (std::abs(c.z() - z_mid) < 0.01f * float(bbox.size().z()))
+                stroke.emplace_back(std::atan2(c.y() - float(bbox.center().y()), c.x() - float(bbox.center().x())), facet_idx);
+        }
+        std::sort(stroke.begin(), stroke.end());
+        const float radius = 0.02f * float(bbox.size().norm());
+        double      t_max  = 0.;
+        b.start();
+        for (const auto &[angle, facet_idx] : stroke) {
+            Benchmark bs;
+            bs.start();
+            Vec3f center = (its.vertices[its.indices[facet_idx](0)] + its.vertices[its.indices[facet_idx](1)] + its.vertices[its.indices[facet_idx](2)]) / 3.f;
+            selector.select_patch(facet_idx, TriangleSelector::SinglePointCursor::cursor_factory(center, camera_pos, radius, TriangleSelector::SPHERE, trafo, clp),
+                EnforcerBlockerType::Extruder3, trafo, true);
+            bs.stop();
+            t_max = std::max(t_max, bs.getElapsedSec());
+        }
+        b.stop();
+        std::cout << "Sphere brush stroke: " << stroke.size() << " steps, total " << b.getElapsedSec() << " s, worst step " << t_max << " s" << std::endl;
+    }
+
+    b.start();
+    TriangleSelector::TriangleSplittingData data = selector.serialize();
+    b.stop();
+    std::cout << "Serialization: " << b.getElapsedSec() << " s, " << data.triangles_to_split.size() << " split triangles" << std::endl;
+}
+
+} // namespace Slic3r
+
+int main(int argc, char **argv)
+{
+    using namespace Slic3r;
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (! mesh.ReadSTLFile(argv[1])) {
+            std::cerr << "Failed to load " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else
+        // About 3M triangles.
+        mesh = TriangleMesh(its_make_sphere(50., 2. * PI / 1800.));
+    replay_strokes(mesh);
+    return EXIT_SUCCESS;
+}
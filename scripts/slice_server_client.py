@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+Stand-in client of the slice server started by `CrealityPrint --server`, see CLI::run_server().
+
+Runs the server, sends it request lines on stdin and checks the prefixed response lines on stdout:
+  - the server announces itself by {"ready": true},
+  - malformed requests, requests without args and nested --server are answered by an error, echoing the request id,
+  - {"exit": true} stops the server.
+If a model and presets are given, it also slices:
+  - the same request twice, each answered by return code 0 and a G-code,
+  - a process preset rewritten with a value of the same length within the same second, which has to be parsed again,
+  - two jobs reporting progress to a --pipe (Linux only), each starting from zero.
+
+Example:
+    python3 scripts/slice_server_client.py build/src/CrealityPrint \
+        --settings "machine.json;process.json" --filaments filament.json --model tests/data/20mm_cube.obj
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+from pathlib import Path
+
+RESPONSE_PREFIX = "slice_server_response: "
+
+
+class SliceServer:
+    def __init__(self, binary, common_args):
+        self.process = subprocess.Popen([binary, "--server"] + common_args, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                        universal_newlines=True, bufsize=1)
+
+    def response(self):
+        # The log of the jobs is interleaved with the responses.
+        for line in self.process.stdout:
+            if line.startswith(RESPONSE_PREFIX):
+                return json.loads(line[len(RESPONSE_PREFIX):])
+        raise RuntimeError("slice server exited with code {} without a response".format(self.process.wait()))
+
+    def send(self, line):
+        self.process.stdin.write(line + "\n")
+        self.process.stdin.flush()
+
+    def request(self, request):
+        self.send(json.dumps(request))
+        return self.response()
+
+    def exit(self):
+        self.send(json.dumps({"exit": True}))
+        return self.process.wait(timeout=60)
+
+
+def check(condition, message):
+    if not condition:
+        raise AssertionError(message)
+    print("OK: " + message)
+
+
+def check_protocol(server):
+    check(server.response() == {"ready": True}, "server announces it is ready")
+    server.send("{not json")
+    response = server.response()
+    check(response.get("return_code", 0) != 0 and "error" in response, "malformed JSON is answered by an error")
+    response = server.request({"id": "no-args"})
+    check(response.get("id") == "no-args" and response.get("return_code", 0) != 0, "request without args is answered by an error with its id")
+    response = server.request({"id": 7, "args": ["--server"]})
+    check(response.get("id") == 7 and response.get("return_code", 0) != 0 and "--server" in response.get("error", ""),
+          "nested --server is refused")
+
+
+def newest_gcode(outputdir):
+    gcodes = sorted(Path(outputdir).glob("*.gcode"), key=lambda path: path.stat().st_mtime)
+    return gcodes[-1].read_text(errors="replace") if gcodes else None
+
+
+def slice_args(args, settings, outputdir, extra=()):
+    out = ["--load_settings", settings]
+    if args.filaments:
+        out += ["--load_filaments", args.filaments]
+    return out + ["--slice", "0", "--outputdir", str(outputdir)] + list(extra) + [args.model]
+
+
+def check_slicing(server, args, workdir):
+    for i in range(2):
+        outputdir = workdir / "out{}".format(i)
+        outputdir.mkdir()
+        response = server.request({"id": i, "args": slice_args(args, args.settings, outputdir)})
+        check(response.get("id") == i and response.get("return_code") == 0, "job {} sliced".format(i))
+        check(newest_gcode(outputdir) is not None, "job {} exported a G-code".format(i))
+
+
+def check_preset_cache(server, args, workdir):
+    machine, process = args.settings.split(";")
+    preset = json.loads(Path(process).read_text())
+    process_copy = workdir / Path(process).name
+    settings = machine + ";" + str(process_copy)
+    for i, layer_height in enumerate(["0.2", "0.3"]):
+        # Same file size, likely the same modification time.
+        preset["layer_height"] = layer_height
+        process_copy.write_text(json.dumps(preset, indent=4))
+        outputdir = workdir / "cache{}".format(i)
+        outputdir.mkdir()
+        response = server.request({"id": "cache{}".format(i), "args": slice_args(args, settings, outputdir)})
+        check(response.get("return_code") == 0, "job with layer_height {} sliced".format(layer_height))
+        gcode = newest_gcode(outputdir) or ""
+        check("; layer_height = " + layer_height in gcode, "rewritten process preset with layer_height {} is parsed again".format(layer_height))
+
+
+def check_pipe_progress(server, args, workdir):
+    fifo = workdir / "progress"
+    os.mkfifo(str(fifo))
+    for i in range(2):
+        progress = []
+        def read_progress():
+            # Blocks until the job opens the pipe, ends when the job closes it.
+            with open(str(fifo)) as pipe:
+                for line in pipe:
+                    progress.append(json.loads(line))
+        reader = threading.Thread(target=read_progress)
+        reader.start()
+        outputdir = workdir / "pipe{}".format(i)
+        outputdir.mkdir()
+        response = server.request({"id": "pipe{}".format(i), "args": slice_args(args, args.settings, outputdir, ["--pipe", str(fifo)])})
+        reader.join(timeout=60)
+        check(response.get("return_code") == 0, "job {} with --pipe sliced".format(i))
+        totals = [p["total_percent"] for p in progress if "total_percent" in p]
+        check(len(totals) > 1 and totals[0] < 10 and totals[-1] > totals[0], "job {} reported its progress from zero".format(i))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in client testing the slice server of CrealityPrint.")
+    parser.add_argument("binary", help="CrealityPrint executable")
+    parser.add_argument("--settings", help="machine and process presets separated by ';', to test slicing")
+    parser.add_argument("--filaments", help="filament presets separated by ';'")
+    parser.add_argument("--model", help="model to slice, to test slicing")
+    args = parser.parse_args()
+
+    workdir = Path(tempfile.mkdtemp(prefix="slice_server_"))
+    server = SliceServer(args.binary, [])
+    try:
+        check_protocol(server)
+        if args.settings and args.model:
+            check_slicing(server, args, workdir)
+            check_preset_cache(server, args, workdir)
+            if sys.platform.startswith("linux"):
+                check_pipe_progress(server, args, workdir)
+        check(server.exit() == 0, "server exits on {\"exit\": true}")
+    except Exception as ex:
+        print("FAILED: {}".format(ex))
+        server.process.kill()
+        return 1
+    finally:
+        shutil.rmtree(str(workdir), ignore_errors=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
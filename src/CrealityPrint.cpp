@@ -34,6 +34,10 @@ static int __cdecl g_cp_sized_new_handler_adapter(size_t bytes) noexcept {
 #include <cstring>
 #include <iostream>
 #include <math.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 #if defined(__linux__) || defined(__LINUX__)
 #include <condition_variable>
@@ -49,6 +53,7 @@ using namespace nlohmann;
 #endif
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
@@ -58,6 +63,8 @@ using namespace nlohmann;
 #include <boost/dll/runtime_symbol_info.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/task_arena.h>
+
 #include "unix/fhs.hpp"  // Generated by CMake from ../platform/unix/fhs.hpp.in
 
 #include "libslic3r/libslic3r.h"
@@ -188,7 +195,12 @@ typedef struct  _sliced_plate_info{
     int plate_id{0};
     size_t sliced_time {0};
     size_t sliced_time_with_cache {0};
+    // Time of Print::process() run concurrently with the other plates, included in sliced_time.
+    size_t process_time {0};
     size_t triangle_count{0};
+    // Volumes sliced by Print::process() and how many of them were reused from the MeshSlicesCache, FFF only.
+    size_t sliced_volumes {0};
+    size_t sliced_volumes_cached {0};
     std::string warning_message;
 }sliced_plate_info_t;
 
@@ -382,6 +394,14 @@ typedef struct _cli_callback_mgr {
             close(m_pipe_fd);
             m_pipe_fd = -1;
         }
+        // Reset the state, so that the next job of the server mode could start() again and report its progress from zero.
+        lck.lock();
+        m_started        = false;
+        m_exit           = false;
+        m_data_ready     = false;
+        m_progress       = 0;
+        m_total_progress = 0;
+        lck.unlock();
         BOOST_LOG_TRIVIAL(info) << "cli_callback_mgr_t::stop successfully.";
     }
 }cli_callback_mgr_t;
@@ -409,6 +429,69 @@ void default_status_callback(const PrintBase::SlicingStatus& slicing_status)
     return;
 }
 
+// Result of Print::process() of a single plate run by process_plates_concurrently().
+typedef struct _parallel_plate_result {
+    bool                                    processed {false};
+    size_t                                  process_time {0};
+    // Print::process() of the sequential slicing loop resets the slicing statistics, keep them from the concurrent run.
+    size_t                                  sliced_volumes {0};
+    size_t                                  sliced_volumes_cached {0};
+    std::mutex                              warnings_mutex;
+    std::vector<PrintBase::SlicingStatus>   warnings;
+}parallel_plate_result_t;
+
+// Run Print::process() of the plates, which were already applied and validated, up to parallel_plates of them at once.
+// Each plate is processed in its own task arena with an even share of the threads. The sequential slicing loop then finds
+// the steps of these plates done and exports their G-code in plate order. A plate failing here is processed again
+// by the sequential slicing loop, which reports the error.
+static void process_plates_concurrently(const std::vector<std::pair<int, Print*>> &plates, int parallel_plates, int threads, std::vector<parallel_plate_result_t> &results)
+{
+    if (plates.empty())
+        return;
+    if (threads <= 0)
+        threads = tbb::this_task_arena::max_concurrency();
+    const int concurrent_plates = std::min(parallel_plates, int(plates.size()));
+    const int threads_per_plate = std::max(1, threads / concurrent_plates);
+    BOOST_LOG_TRIVIAL(info) << boost::format("slicing %1% plates, %2% of them concurrently with %3% threads each")%plates.size() %concurrent_plates %threads_per_plate;
+    // Print::process() names the TBB threads on its first call, do it before the plates are processed concurrently.
+    name_tbb_thread_pool_threads_set_locale();
+
+    std::atomic<size_t> next_plate {0};
+    auto worker = [&plates, &results, &next_plate, threads_per_plate]() {
+        tbb::task_arena arena(threads_per_plate);
+        for (size_t i = next_plate ++; i < plates.size(); i = next_plate ++) {
+            int                      index  = plates[i].first;
+            Print                   *print  = plates[i].second;
+            parallel_plate_result_t &result = results[index];
+            // The warnings are collected per plate and reported by the sequential slicing loop in plate order.
+            print->set_status_callback([&result](const PrintBase::SlicingStatus &slicing_status) {
+                if (slicing_status.warning_step != -1) {
+                    std::lock_guard<std::mutex> lock(result.warnings_mutex);
+                    result.warnings.push_back(slicing_status);
+                }
+            });
+            long long start_time = (long long)Slic3r::Utils::get_current_time_utc();
+            try {
+                arena.execute([print]() { print->process(); });
+                result.processed             = true;
+                result.sliced_volumes        = print->print_statistics().sliced_volumes;
+                result.sliced_volumes_cached = print->print_statistics().sliced_volumes_cached;
+            } catch (const std::exception &ex) {
+                BOOST_LOG_TRIVIAL(warning) << boost::format("plate %1%: concurrent slicing failed: %2%, will be sliced again")%(index+1) %ex.what();
+                result.warnings.clear();
+            }
+            result.process_time = size_t((long long)Slic3r::Utils::get_current_time_utc() - start_time);
+            BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%: Print::process finished in %2% secs")%(index+1) %result.process_time;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < concurrent_plates; ++ i)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread &thread : workers)
+        thread.join();
+}
+
 
 static PrinterTechnology get_printer_technology(const DynamicConfig &config)
 {
@@ -464,7 +547,10 @@ void record_exit_reson(std::string outputdir, int code, int plate_id, std::strin
             plate_json["id"] = sliced_info.sliced_plates[index].plate_id;
             plate_json["sliced_time"] = sliced_info.sliced_plates[index].sliced_time;
             plate_json["sliced_time_with_cache"] = sliced_info.sliced_plates[index].sliced_time_with_cache;
+            plate_json["process_time"] = sliced_info.sliced_plates[index].process_time;
             plate_json["triangle_count"] = sliced_info.sliced_plates[index].triangle_count;
+            plate_json["sliced_volumes"] = sliced_info.sliced_plates[index].sliced_volumes;
+            plate_json["sliced_volumes_cached"] = sliced_info.sliced_plates[index].sliced_volumes_cached;
             plate_json["warning_message"] = sliced_info.sliced_plates[index].warning_message;
             j["sliced_plates"].push_back(plate_json);
         }
@@ -562,6 +648,46 @@ static int load_key_values_from_json(const std::string &file, std::map<std::stri
     return 0;
 }
 
+// Preset files parsed by this process, kept for the following jobs of the slice server (see CLI::run_server()).
+// A file is parsed again once its content changes. The modification time is not reliable for that,
+// as it has a resolution of a second and a preset may be rewritten by the next job within the same second.
+typedef struct _loaded_config_file {
+    size_t                              size { 0 };
+    size_t                              hash { 0 };
+    DynamicPrintConfig                  config;
+    std::map<std::string, std::string>  key_values;
+}loaded_config_file_t;
+static std::mutex                                   g_loaded_config_files_mutex;
+static std::map<std::string, loaded_config_file_t>  g_loaded_config_files;
+
+static ConfigSubstitutions load_config_from_json_cached(const std::string &file, ForwardCompatibilitySubstitutionRule compatibility_rule, DynamicPrintConfig &config,
+                                                        std::map<std::string, std::string> &key_values, std::string &reason)
+{
+    // Hashing the content is much cheaper than parsing the json and resolving the config options.
+    boost::nowide::ifstream ifs(file, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    const bool   cacheable = ifs.good() || ifs.eof();
+    const size_t hash      = std::hash<std::string>()(content);
+    if (cacheable) {
+        std::lock_guard<std::mutex> lock(g_loaded_config_files_mutex);
+        auto it = g_loaded_config_files.find(file);
+        if (it != g_loaded_config_files.end() && it->second.size == content.size() && it->second.hash == hash) {
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": reuse the parsed setting file " << file;
+            config.apply(it->second.config);
+            key_values = it->second.key_values;
+            return {};
+        }
+    }
+
+    ConfigSubstitutions config_substitutions = config.load_from_json(file, compatibility_rule, key_values, reason);
+    // Files with legacy values are parsed again to report the substitutions.
+    if (cacheable && reason.empty() && config_substitutions.empty()) {
+        std::lock_guard<std::mutex> lock(g_loaded_config_files_mutex);
+        g_loaded_config_files[file] = { content.size(), hash, config, key_values };
+    }
+    return config_substitutions;
+}
+
 static std::set<std::string> gcodes_key_set =  {"filament_end_gcode", "filament_start_gcode", "change_filament_gcode", "layer_change_gcode", "machine_end_gcode", "machine_pause_gcode", "machine_start_gcode",
             "template_custom_gcode", "printing_by_object_gcode", "before_layer_change_gcode", "time_lapse_gcode"};
 
@@ -1116,6 +1242,8 @@ int CLI::run(int argc, char **argv)
         return CLI_INVALID_PARAMS;
     }
     BOOST_LOG_TRIVIAL(info) << "finished setup params, argc="<< argc << std::endl;
+    if (m_config.opt_bool("server"))
+        return run_server(argc, argv);
         // Handle minidump crash report parameter on Linux (similar to Windows implementation)
     
     std::string temp_path = wxFileName::GetTempDir().utf8_str().data();
@@ -1722,7 +1850,7 @@ int CLI::run(int argc, char **argv)
             std::map<std::string, std::string> key_values;
             std::string reason;
 
-            config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
+            config_substitutions = load_config_from_json_cached(file, config_substitution_rule, config, key_values, reason);
             if (!reason.empty()) {
                 BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<<  ":Can not load config from file "<<file<<"\n";
                 return CLI_CONFIG_FILE_ERROR;
@@ -4794,6 +4922,25 @@ int CLI::run(int argc, char **argv)
                 std::string outfile;
                 //Print       fff_print;
                 std::vector<size_t> plate_triangle_counts(partplate_list.get_plate_count(), 0);
+                std::vector<parallel_plate_result_t> parallel_plate_results(partplate_list.get_plate_count());
+                //check whether it is bbl printer
+                auto is_bbl_vendor_preset_config = [&new_printer_name, &current_printer_system_name](DynamicPrintConfig &print_config) {
+                    std::string& printer_model_string = print_config.opt_string("printer_model", true);
+                    bool is_bbl_vendor_preset = false;
+
+                    if (!printer_model_string.empty()) {
+                        is_bbl_vendor_preset = (printer_model_string.compare(0, 9, "Bambu Lab") == 0);
+                        BOOST_LOG_TRIVIAL(info) << boost::format("printer_model_string: %1%, is_bbl_vendor_preset %2%")%printer_model_string %is_bbl_vendor_preset;
+                    }
+                    else {
+                        if (!new_printer_name.empty())
+                            is_bbl_vendor_preset = (new_printer_name.compare(0, 9, "Bambu Lab") == 0);
+                        else if (!current_printer_system_name.empty())
+                            is_bbl_vendor_preset = (current_printer_system_name.compare(0, 9, "Bambu Lab") == 0);
+                        BOOST_LOG_TRIVIAL(info) << boost::format("new_printer_name: %1%, current_printer_system_name %2%, is_bbl_vendor_preset %3%")%new_printer_name %current_printer_system_name %is_bbl_vendor_preset;
+                    }
+                    return is_bbl_vendor_preset;
+                };
 
                 while(!finished)
                 {
@@ -5008,22 +5155,7 @@ int CLI::run(int argc, char **argv)
                                 BOOST_LOG_TRIVIAL(info) << "set print's callback to default_status_callback.";
                                 print->set_status_callback(default_status_callback);
 #endif
-                                //check whether it is bbl printer
-                                std::string& printer_model_string = new_print_config.opt_string("printer_model", true);
-                                bool is_bbl_vendor_preset = false;
-
-                                if (!printer_model_string.empty()) {
-                                    is_bbl_vendor_preset = (printer_model_string.compare(0, 9, "Bambu Lab") == 0);
-                                    BOOST_LOG_TRIVIAL(info) << boost::format("printer_model_string: %1%, is_bbl_vendor_preset %2%")%printer_model_string %is_bbl_vendor_preset;
-                                }
-                                else {
-                                    if (!new_printer_name.empty())
-                                        is_bbl_vendor_preset = (new_printer_name.compare(0, 9, "Bambu Lab") == 0);
-                                    else if (!current_printer_system_name.empty())
-                                        is_bbl_vendor_preset = (current_printer_system_name.compare(0, 9, "Bambu Lab") == 0);
-                                    BOOST_LOG_TRIVIAL(info) << boost::format("new_printer_name: %1%, current_printer_system_name %2%, is_bbl_vendor_preset %3%")%new_printer_name %current_printer_system_name %is_bbl_vendor_preset;
-                                }
-                                (dynamic_cast<Print*>(print))->set_is_BBL_printer(is_bbl_vendor_preset);
+                                (dynamic_cast<Print*>(print))->set_is_BBL_printer(is_bbl_vendor_preset_config(new_print_config));
 
                                 //update information for brim
                                 const PrintConfig& print_config = print_fff->config();
@@ -5052,8 +5184,20 @@ int CLI::run(int argc, char **argv)
                                 else {
                                     print->process(&time_using_cache);
                                     BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << time_using_cache << " secs.";
+                                    if (parallel_plate_results[index].processed) {
+                                        // Processed already by process_plates_concurrently(), report its warnings now.
+                                        append(g_slicing_warnings, std::move(parallel_plate_results[index].warnings));
+                                        sliced_plate_info.process_time = parallel_plate_results[index].process_time;
+                                    }
                                 }
                                 if (printer_technology == ptFFF) {
+                                    if (parallel_plate_results[index].processed) {
+                                        sliced_plate_info.sliced_volumes        = parallel_plate_results[index].sliced_volumes;
+                                        sliced_plate_info.sliced_volumes_cached = parallel_plate_results[index].sliced_volumes_cached;
+                                    } else {
+                                        sliced_plate_info.sliced_volumes        = print_fff->print_statistics().sliced_volumes;
+                                        sliced_plate_info.sliced_volumes_cached = print_fff->print_statistics().sliced_volumes_cached;
+                                    }
                                     std::string conflict_result = print_fff->get_conflict_string();
                                     if (!conflict_result.empty()) {
                                        BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": found slicing result conflict!"<< std::endl;
@@ -5149,11 +5293,11 @@ int CLI::run(int argc, char **argv)
                                     }
                                 }
                                 end_time = (long long)Slic3r::Utils::get_current_time_utc();
-                                sliced_plate_info.sliced_time = end_time - start_time;
+                                sliced_plate_info.sliced_time = end_time - start_time + sliced_plate_info.process_time;
                                 sliced_plate_info.sliced_time_with_cache = time_using_cache;
 
                                 if (max_slicing_time_per_plate != 0) {
-                                    long long time_cost = end_time - start_time;
+                                    long long time_cost = sliced_plate_info.sliced_time;
                                     if (time_cost > max_slicing_time_per_plate) {
                                         sliced_plate_info.warning_message = (boost::format("plate %1%'s slice time %2% exceeds the limit %3%, return error.")%(index+1) %time_cost %max_slicing_time_per_plate).str();
                                         BOOST_LOG_TRIVIAL(error) << sliced_plate_info.warning_message;
@@ -5172,8 +5316,37 @@ int CLI::run(int argc, char **argv)
                             }
                         }
                     }
-                    if (pre_check&& (partplate_list.get_plate_count() > 1))
+                    if (pre_check&& (partplate_list.get_plate_count() > 1)) {
                         pre_check = false;
+                        // All the plates were applied and validated by the pre-check, process them concurrently before exporting them one by one.
+                        const ConfigOptionInt *parallel_plates_option = m_config.option<ConfigOptionInt>("parallel_plates");
+                        const ConfigOptionInt *parallel_plates_threads_option = m_config.option<ConfigOptionInt>("parallel_plates_threads");
+                        int parallel_plates = parallel_plates_option ? parallel_plates_option->value : 0;
+                        if (parallel_plates > 1 && !load_slicedata && printer_technology == ptFFF) {
+                            std::vector<std::pair<int, Print*>> plates;
+                            for (int index = 0; index < partplate_list.get_plate_count(); index ++) {
+                                Slic3r::GUI::PartPlate* part_plate = partplate_list.get_plate(index);
+                                part_plate->get_print(&print, &gcode_result, &print_index);
+                                print_fff = dynamic_cast<Print *>(print);
+                                if (print_fff == nullptr || print_fff->empty())
+                                    continue;
+                                // Model::setPrintSpeedTable() sets the process wide bed polygon from the first plate's print config,
+                                // the plates with a different bed exclude area are left to the sequential slicing loop.
+                                if (!plates.empty() && print_fff->config().bed_exclude_area.values != plates.front().second->config().bed_exclude_area.values)
+                                    continue;
+                                DynamicPrintConfig new_print_config = m_print_config;
+                                new_print_config.apply(*part_plate->config());
+                                new_print_config.apply(m_extra_config, true);
+                                print_fff->set_is_BBL_printer(is_bbl_vendor_preset_config(new_print_config));
+                                plates.emplace_back(index, print_fff);
+                            }
+                            if (!plates.empty()) {
+                                Model::setExtruderParams(m_print_config, filament_count);
+                                Model::setPrintSpeedTable(m_print_config, plates.front().second->config());
+                                process_plates_concurrently(plates, parallel_plates, parallel_plates_threads_option ? parallel_plates_threads_option->value : 0, parallel_plate_results);
+                            }
+                        }
+                    }
                     else
                         finished = true;
                 }//end for partplate
@@ -6180,6 +6353,94 @@ bool CLI::export_project(Model *model, std::string& path, PlateDataPtrs &partpla
     return true;
 }
 
+static bool is_server_arg(const std::string &arg)
+{
+    return arg == "--server" || boost::starts_with(arg, "--server=");
+}
+
+// Slice server started by --server: runs the slice requests one after another in this process, thus the parsed preset
+// files (see load_config_from_json_cached()), the TBB worker threads and the process wide caches stay warm between jobs.
+// Each request is a single line of JSON on stdin, for example
+//     {"id": 1, "args": ["--load_settings", "machine.json;process.json", "--slice", "0", "--outputdir", "out", "model.3mf"]}
+// The args are appended to the command line of the server without --server, thus the common options are passed once
+// when starting the server and each request adds its input, output and preset overrides.
+// Each request is answered by a single line on stdout, which is prefixed to be told apart from the log of the job:
+//     slice_server_response: {"id": 1, "return_code": 0, "time": 1234}
+// where time is in milliseconds.
+// {"exit": true} or the end of stdin stops the server.
+// scripts/slice_server_client.py is a stand-in client testing this protocol, the preset cache and the progress pipe.
+#define SLICE_SERVER_RESPONSE "slice_server_response: "
+
+int CLI::run_server(int argc, char **argv)
+{
+    std::vector<std::string> server_args;
+    for (int i = 1; i < argc; ++ i)
+        if (! is_server_arg(argv[i]))
+            server_args.emplace_back(argv[i]);
+
+    auto respond = [](const json &response) {
+        boost::nowide::cout << SLICE_SERVER_RESPONSE << response.dump() << std::endl;
+    };
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": slice server started with " << server_args.size() << " common args, waiting for requests";
+    respond(json{ { "ready", true } });
+
+    std::string line;
+    while (std::getline(boost::nowide::cin, line)) {
+        boost::algorithm::trim(line);
+        if (line.empty())
+            continue;
+
+        json request, response;
+        std::vector<std::string> args { argv[0] };
+        append(args, server_args);
+        try {
+            request = json::parse(line);
+            if (request.contains("id"))
+                response["id"] = request["id"];
+            if (request.value("exit", false))
+                break;
+            for (const json &arg : request.at("args"))
+                args.emplace_back(arg.get<std::string>());
+        } catch (const std::exception &ex) {
+            response["return_code"] = CLI_INVALID_PARAMS;
+            response["error"]       = ex.what();
+            respond(response);
+            continue;
+        }
+        if (std::any_of(args.begin() + 1, args.end(), is_server_arg)) {
+            response["return_code"] = CLI_INVALID_PARAMS;
+            response["error"]       = "--server is not allowed in a slice request";
+            respond(response);
+            continue;
+        }
+
+        std::vector<char*> job_argv;
+        for (std::string &arg : args)
+            job_argv.emplace_back(arg.data());
+        job_argv.emplace_back(nullptr);
+
+        // Warnings are collected globally by the status callback of a job.
+        g_slicing_warnings.clear();
+        auto start_time = std::chrono::steady_clock::now();
+        int  ret        = CLI_SUCCESS;
+        try {
+            ret = CLI().run(int(args.size()), job_argv.data());
+        } catch (const std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": slice request failed: " << ex.what();
+            ret = CLI_SLICING_ERROR;
+            response["error"] = ex.what();
+        }
+        g_slicing_warnings.clear();
+        response["return_code"] = ret;
+        response["time"]        = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+        respond(response);
+    }
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": slice server stopped";
+    return CLI_SUCCESS;
+}
+
 std::string CLI::output_filepath(const Model &model, IO::ExportFormat format) const
 {
     std::string ext;
@@ -112,6 +112,9 @@ private:
 
     bool setup(int argc, char **argv);
 
+    /// Runs the slice requests read from stdin until stopped, see --server.
+    static int run_server(int argc, char **argv);
+
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptAny) const;
 
@@ -788,15 +788,41 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
+  std::vector<TEdge> edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
     // Success, remember the edge array.
     m_edges.emplace_back(std::move(edges));
+  else
+    ReleaseEdges(std::move(edges));
   return result;
 }
 
+// Limit of the edges kept by a reused Clipper object, summed over all of its free edge arrays:
+// Keep the buffers of the frequent small operations, don't hold memory of the occasional large ones.
+// A reused Clipper object is usually thread local, thus the limit applies per thread.
+static constexpr const size_t EdgesFreeMaxCapacity = 16384;
+
+std::vector<TEdge> ClipperBase::AllocateEdges(size_t num_edges)
+{
+  if (m_edges_free.empty())
+    return std::vector<TEdge>(num_edges);
+  std::vector<TEdge> edges = std::move(m_edges_free.back());
+  m_edges_free.pop_back();
+  m_edges_free_capacity -= edges.capacity();
+  edges.assign(num_edges, TEdge());
+  return edges;
+}
+
+void ClipperBase::ReleaseEdges(std::vector<TEdge> &&edges)
+{
+  if (edges.capacity() > 0 && m_edges_free_capacity + edges.capacity() <= EdgesFreeMaxCapacity) {
+    m_edges_free_capacity += edges.capacity();
+    m_edges_free.emplace_back(std::move(edges));
+  }
+}
+
 bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
   CLIPPERLIB_PROFILE_FUNC();
@@ -979,6 +1005,8 @@ void ClipperBase::Clear()
 {
   CLIPPERLIB_PROFILE_FUNC();
   m_MinimaList.clear();
+  for (std::vector<TEdge> &edges : m_edges)
+    ReleaseEdges(std::move(edges));
   m_edges.clear();
 #ifndef CLIPPERLIB_INT32
   m_UseFullRange = false;
@@ -1066,6 +1094,7 @@ Clipper::Clipper(int initOptions) :
   m_OutPtsFree(nullptr),
   m_OutPtsChunkSize(32),
   m_OutPtsChunkLast(32),
+  m_OutPtsChunksUsed(0),
   m_ActiveEdges(nullptr),
   m_SortedEdges(nullptr)
 {
@@ -1083,7 +1112,7 @@ void Clipper::Reset()
 {
   CLIPPERLIB_PROFILE_FUNC();
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt>();
+  m_Scanbeam.clear();
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
@@ -1205,27 +1234,48 @@ OutPt* Clipper::AllocateOutPt()
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
     // Get a point from the last chunk.
-    pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
+    pt = m_OutPts[m_OutPtsChunksUsed - 1] + (m_OutPtsChunkLast ++);
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    // The last chunk is full. Take the next chunk kept from the previous operation or allocate a new one.
+    if (m_OutPtsChunksUsed == m_OutPts.size())
+      m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    pt = m_OutPts[m_OutPtsChunksUsed ++];
     m_OutPtsChunkLast = 1;
-    pt = m_OutPts.back();
   }
   return pt;
 }
 
+// Limits of the output buffers kept by a reused Clipper object.
+static constexpr const size_t OutPtsChunksMaxRetained = 64;
+static constexpr const size_t OutRecsMaxRetained      = 256;
+
 void Clipper::DisposeAllOutRecs()
 {
-  for (OutPt *pts : m_OutPts)
-    delete[] pts;
+  // Keep some of the output points and output polygons allocated for the next operation.
+  for (size_t i = OutPtsChunksMaxRetained; i < m_OutPts.size(); ++ i)
+    delete[] m_OutPts[i];
+  if (m_OutPts.size() > OutPtsChunksMaxRetained)
+    m_OutPts.resize(OutPtsChunksMaxRetained);
   for (OutRec *rec : m_PolyOuts)
-    delete rec;
-  m_OutPts.clear();
+    if (m_OutRecsFree.size() < OutRecsMaxRetained)
+      m_OutRecsFree.emplace_back(rec);
+    else
+      delete rec;
+  m_OutPtsChunksUsed = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
   m_PolyOuts.clear();
 }
+
+void Clipper::FreeBuffers()
+{
+  for (OutPt *pts : m_OutPts)
+    delete[] pts;
+  m_OutPts.clear();
+  for (OutRec *rec : m_OutRecsFree)
+    delete rec;
+  m_OutRecsFree.clear();
+}
 //------------------------------------------------------------------------------
 
 void Clipper::SetWindingCount(TEdge &edge) const
@@ -2004,7 +2054,13 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2) const
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result;
+  if (m_OutRecsFree.empty())
+    result = new OutRec;
+  else {
+    result = m_OutRecsFree.back();
+    m_OutRecsFree.pop_back();
+  }
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -3359,17 +3415,44 @@ DoublePoint GetUnitNormal(const IntPoint &pt1, const IntPoint &pt2)
 void ClipperOffset::Clear()
 {
   for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+    ReleaseNode(m_polyNodes.Childs[i]);
   m_polyNodes.Childs.clear();
   m_lowest.x() = -1;
 }
 //------------------------------------------------------------------------------
 
+// Limits of the nodes kept by a reused ClipperOffset object.
+static constexpr const size_t OffsetNodesMaxRetained        = 64;
+static constexpr const size_t OffsetNodeMaxRetainedCapacity = 4096;
+
+PolyNode* ClipperOffset::AllocateNode()
+{
+  if (m_freeNodes.empty())
+    return new PolyNode();
+  PolyNode *node = m_freeNodes.back();
+  m_freeNodes.pop_back();
+  node->Contour.clear();
+  node->Childs.clear();
+  node->Parent = nullptr;
+  node->Index = 0;
+  node->m_IsOpen = false;
+  return node;
+}
+
+void ClipperOffset::ReleaseNode(PolyNode *node)
+{
+  if (m_freeNodes.size() < OffsetNodesMaxRetained && node->Contour.capacity() <= OffsetNodeMaxRetainedCapacity)
+    m_freeNodes.emplace_back(node);
+  else
+    delete node;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType)
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode = AllocateNode();
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3409,7 +3492,7 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
   }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    ReleaseNode(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -331,7 +331,7 @@ public:
       return false;
 
     // Allocate a new edge array.
-    std::vector<TEdge> edges(num_edges_total);
+    std::vector<TEdge> edges = AllocateEdges(num_edges_total);
     // Fill in the edge array.
     bool result = false;
     TEdge *p_edge = edges.data();
@@ -349,6 +349,8 @@ public:
     if (result)
       // At least some edges were generated. Remember the edge array.
       m_edges.emplace_back(std::move(edges));
+    else
+      ReleaseEdges(std::move(edges));
     return result;
   }
 
@@ -365,6 +367,10 @@ protected:
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
   TEdge* DescendToMin(TEdge *&E);
   void AscendToMax(TEdge *&E, bool Appending, bool IsClosed);
+  // Take an edge array from m_edges_free if possible.
+  std::vector<TEdge> AllocateEdges(size_t num_edges);
+  // Keep a small edge array in m_edges_free for reuse after Clear().
+  void ReleaseEdges(std::vector<TEdge> &&edges);
 
   // Local minima (Y, left edge, right edge) sorted by ascending Y.
   std::vector<LocalMinimum> m_MinimaList;
@@ -379,6 +385,10 @@ protected:
 
   // A vector of edges per each input path.
   std::vector<std::vector<TEdge>> m_edges;
+  // Edge arrays released by Clear(), reused when the Clipper object is reused for another operation.
+  std::vector<std::vector<TEdge>> m_edges_free;
+  // Sum of capacities of m_edges_free.
+  size_t                          m_edges_free_capacity { 0 };
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -390,7 +400,7 @@ class Clipper : public ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
-  ~Clipper() { Clear(); }
+  ~Clipper() { Clear(); FreeBuffers(); }
   void Clear() { ClipperBase::Clear(); DisposeAllOutRecs(); }
   bool Execute(ClipType clipType,
       Paths &solution,
@@ -424,18 +434,27 @@ private:
   // Output polygons.
   std::vector<OutRec*>  m_PolyOuts;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // Some of the chunks are kept allocated after Clear() for the next operation of this Clipper object.
   std::vector<OutPt*>   m_OutPts;
+  // Number of chunks of m_OutPts in use.
+  size_t                m_OutPtsChunksUsed;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
   size_t                m_OutPtsChunkLast;
 
+  // Output polygons released by Clear(), to be reused by CreateOutRec().
+  std::vector<OutRec*>  m_OutRecsFree;
+
   std::vector<Join>     m_Joins;
   std::vector<Join>     m_GhostJoins;
   std::vector<IntersectNode> m_IntersectList;
   ClipType              m_ClipType;
-  // A priority queue (a binary heap) of Y coordinates.
-  std::priority_queue<cInt> m_Scanbeam;
+  // A priority queue (a binary heap) of Y coordinates, which keeps its memory when cleared.
+  struct Scanbeam : public std::priority_queue<cInt> {
+    void clear() { this->c.clear(); }
+  };
+  Scanbeam              m_Scanbeam;
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
   std::vector<cInt>     m_Maxima;
   TEdge                *m_ActiveEdges;
@@ -482,6 +501,8 @@ private:
   void DisposeOutPt(OutPt *pt) { pt->Next = m_OutPtsFree; m_OutPtsFree = pt; }
   void DisposeOutPts(OutPt*& pp) { if (pp != nullptr) { pp->Prev->Next = m_OutPtsFree; m_OutPtsFree = pp; } }
   void DisposeAllOutRecs();
+  // Release the output points and output polygons kept for reuse.
+  void FreeBuffers();
   bool ProcessIntersections(const cInt topY);
   void BuildIntersectList(const cInt topY);
   void ProcessEdgesAtTopOfScanbeam(const cInt topY);
@@ -510,7 +531,7 @@ class ClipperOffset
 public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
     MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
-  ~ClipperOffset() { Clear(); }
+  ~ClipperOffset() { Clear(); for (PolyNode *node : m_freeNodes) delete node; }
   void AddPath(const Path& path, JoinType joinType, EndType endType);
   template<typename PathsProvider>
   void AddPaths(PathsProvider &&paths, JoinType joinType, EndType endType) {
@@ -535,7 +556,11 @@ private:
   // y: index of the lowest point in the lowest contour
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Nodes released by Clear(), reused by AddPath().
+  PolyNodes m_freeNodes;
 
+  PolyNode* AllocateNode();
+  void ReleaseNode(PolyNode *node);
   void FixOrientations();
   void DoOffset(double delta);
   void OffsetPoint(int j, int& k, JoinType jointype);
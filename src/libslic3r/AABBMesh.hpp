@@ -28,6 +28,8 @@ class AABBMesh {
     class AABBImpl;
 
     const indexed_triangle_set* m_tm;
+    // Keeps the mesh alive if the AABBMesh was created over a shared mesh.
+    std::shared_ptr<const TriangleMesh> m_mesh;
 
     std::unique_ptr<AABBImpl> m_aabb;
     VertexFaceIndex m_vfidx;    // vertex-face index
@@ -47,6 +49,8 @@ public:
     // If set to false, a default epsilon is used, which works for "reasonable" meshes.
     explicit AABBMesh(const indexed_triangle_set &tmesh, bool calculate_epsilon = false);
     explicit AABBMesh(const TriangleMesh &mesh, bool calculate_epsilon = false);
+    // The AABB tree is shared through AABBTreeCache with the other users of the same mesh.
+    explicit AABBMesh(const std::shared_ptr<const TriangleMesh> &mesh, bool calculate_epsilon = false);
     
     AABBMesh(const AABBMesh& other);
     AABBMesh& operator=(const AABBMesh&);
@@ -0,0 +1,65 @@
+#include "AABBTreeCache.hpp"
+
+#include "TriangleMesh.hpp"
+
+#include <tbb/task_arena.h>
+
+namespace Slic3r {
+
+AABBTreeCache& AABBTreeCache::instance()
+{
+    static AABBTreeCache cache;
+    return cache;
+}
+
+std::shared_ptr<const AABBTreeCache::Tree> AABBTreeCache::get(const std::shared_ptr<const TriangleMesh> &mesh)
+{
+    assert(mesh);
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(mesh.get());
+        // The address of a destroyed mesh may be reused by a new one.
+        if (it == m_entries.end() || it->second->mesh.lock() != mesh) {
+            purge();
+            entry = std::make_shared<Entry>();
+            entry->mesh = mesh;
+            m_entries[mesh.get()] = entry;
+        } else
+            entry = it->second;
+    }
+
+    // Build outside of the cache lock, so that trees of different meshes are built concurrently.
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    std::shared_ptr<const Tree> tree = entry->tree.lock();
+    if (! tree) {
+        // The build is parallel. Isolate it, so that a thread waiting for the build does not pick up
+        // an unrelated task requesting the same mesh and lock the entry again.
+        tbb::this_task_arena::isolate([&tree, &mesh]() {
+            tree = std::make_shared<const Tree>(AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh->its.vertices, mesh->its.indices));
+        });
+        entry->tree = tree;
+    }
+    return tree;
+}
+
+size_t AABBTreeCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t cnt = 0;
+    for (const auto &kvp : m_entries)
+        if (! kvp.second->mesh.expired() && ! kvp.second->tree.expired())
+            ++ cnt;
+    return cnt;
+}
+
+void AABBTreeCache::purge()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+        if (it->second->mesh.expired())
+            it = m_entries.erase(it);
+        else
+            ++ it;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,52 @@
+#ifndef slic3r_AABBTreeCache_hpp_
+#define slic3r_AABBTreeCache_hpp_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "AABBTreeIndirect.hpp"
+
+namespace Slic3r {
+
+class TriangleMesh;
+
+// Process wide cache of AABB trees built over the vertices of shared immutable meshes,
+// for example ModelVolume::mesh_ptr(). The same mesh is referenced by the scene raycasters,
+// by the gizmos and by the raycast manager, each of them would otherwise index it again.
+// The tree is built in the mesh coordinate system, the users transform their queries into it.
+// The cache does not keep the trees alive, a tree is released together with its last user.
+// A mesh is never modified once shared, a changed mesh is a new object and thus a new cache key.
+class AABBTreeCache
+{
+public:
+    using Tree = AABBTreeIndirect::Tree3f;
+
+    static AABBTreeCache& instance();
+
+    // Returns a tree built over mesh->its, building it if no live tree exists for the mesh yet.
+    // Concurrent requests for the same mesh wait for a single build. Thread safe.
+    std::shared_ptr<const Tree> get(const std::shared_ptr<const TriangleMesh> &mesh);
+
+    // Number of meshes with a live tree, for debugging and testing.
+    size_t size() const;
+
+private:
+    AABBTreeCache() = default;
+
+    struct Entry {
+        std::weak_ptr<const TriangleMesh> mesh;
+        std::mutex                        mutex;
+        std::weak_ptr<const Tree>         tree;
+    };
+
+    // Drop the entries of destroyed meshes. Called with m_mutex locked.
+    void purge();
+
+    mutable std::mutex                                           m_mutex;
+    std::unordered_map<const TriangleMesh*, std::shared_ptr<Entry>> m_entries;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_AABBTreeCache_hpp_
@@ -7,18 +7,34 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 #include <vector>
 
 #include <Eigen/Geometry>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+
 #include "BoundingBox.hpp"
 #include "Utils.hpp" // for next_highest_power_of_2()
 
 // Definition of the ray intersection hit structure.
 #include <igl/Hit.h>
 
+// Box tests of ray packets over float trees are vectorized if the target supports it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SLIC3R_AABB_RAY_PACKET_SSE2
+	#include <emmintrin.h>
+#endif
+#ifdef __AVX__
+	#define SLIC3R_AABB_RAY_PACKET_AVX
+	#include <immintrin.h>
+#endif
+
 namespace Slic3r {
 namespace AABBTreeIndirect {
 
@@ -145,10 +161,20 @@ private:
 		// Insert an inner node into the tree. Inner node does not reference any input entity (triangle, line segment etc).
 		m_nodes[node].idx  = inner;
 		m_nodes[node].bbox = bbox;
-        build_recursive(input, node * 2 + 1, left, center);
-		build_recursive(input, node * 2 + 2, center + 1, right);
+        if (right - left > parallel_build_threshold)
+            // The two subtrees reference disjoint parts of the input and disjoint nodes, build them in parallel.
+            tbb::parallel_invoke(
+                [this, &input, node, left, center]()  { build_recursive(input, node * 2 + 1, left, center); },
+                [this, &input, node, center, right]() { build_recursive(input, node * 2 + 2, center + 1, right); });
+        else {
+            build_recursive(input, node * 2 + 1, left, center);
+            build_recursive(input, node * 2 + 2, center + 1, right);
+        }
 	}
 
+	// Subtrees over less input entities than this are built serially.
+	static constexpr size_t parallel_build_threshold = 16384;
+
 	// Partition the input m_nodes <left, right> at "k" and "dimension" using the QuickSelect method:
 	// https://en.wikipedia.org/wiki/Quickselect
 	// Items left of the k'th item are lower than the k'th item in the "dimension", 
@@ -218,6 +244,145 @@ using Tree3f = Tree<3, float>;
 using Tree2d = Tree<2, double>;
 using Tree3d = Tree<3, double>;
 
+// Wide AABB tree flattened from the balanced binary Tree above.
+// Each node stores the bounding boxes of up to Arity children as a structure of arrays, so that a query tests
+// all the children of a node in a single tight loop, and the nodes are stored in depth first order, so that a subtree
+// occupies a contiguous block of memory. A traversal visits about log2(Arity) times fewer nodes than over the binary
+// Tree and it touches fewer cache lines, which pays off on meshes that do not fit the CPU caches.
+// The ray casting, closest point and point containment queries below are overloaded for the WideTree.
+template<int ANumDimensions, typename ACoordType, int AArity = 4>
+class WideTree
+{
+public:
+    static constexpr int    NumDimensions = ANumDimensions;
+    static constexpr int    Arity         = AArity;
+	using					CoordType     = ACoordType;
+    using  					BoundingBox   = Eigen::AlignedBox<CoordType, NumDimensions>;
+    using 					BinaryTree    = Tree<NumDimensions, CoordType>;
+    static_assert(Arity >= 2 && Arity <= 32, "WideTree arity must fit a 32 bit mask");
+
+    enum : size_t {
+    	// Child is not used.
+        npos = size_t(-1)
+    };
+
+    struct Node {
+    	// Bounding boxes of the children.
+        alignas(32) CoordType	min[NumDimensions][Arity];
+        alignas(32) CoordType	max[NumDimensions][Arity];
+        // Index of a child in WideTree::nodes() for an inner child, index of the external source entity for a leaf child.
+        size_t 					child[Arity];
+        // Bit i is set if the i-th child is used.
+        uint32_t 				valid_mask = 0;
+        // Bit i is set if the i-th child references an external source entity.
+        uint32_t 				leaf_mask  = 0;
+
+        bool 		is_valid(int i) const { return (this->valid_mask >> i) & 1; }
+        bool 		is_leaf(int i)  const { return (this->leaf_mask >> i) & 1; }
+        BoundingBox bbox(int i) const {
+        	BoundingBox out;
+        	for (int dim = 0; dim < NumDimensions; ++ dim) {
+        		out.min()(dim) = this->min[dim][i];
+        		out.max()(dim) = this->max[dim][i];
+        	}
+        	return out;
+        }
+    };
+
+    WideTree() = default;
+    explicit WideTree(const BinaryTree &tree) { this->build(tree); }
+
+	void clear() { m_nodes.clear(); }
+
+	// Flatten a balanced binary tree. Two levels of the binary tree collapse into a single node of the WideTree
+	// for Arity = 4, three levels for Arity = 8. An inner child with the largest bounding box is always expanded first.
+	void build(const BinaryTree &tree)
+	{
+		m_nodes.clear();
+		if (! tree.empty()) {
+			// A balanced tree over n entities has less than n inner nodes, a wide node replaces at least Arity / 2 of them.
+			m_nodes.reserve(tree.nodes().size() / Arity + 1);
+			this->build_recursive(tree, 0);
+		}
+	}
+
+	const std::vector<Node>& 	nodes() const { return m_nodes; }
+	const Node& 				node(size_t idx) const { return m_nodes[idx]; }
+	bool 						empty() const { return m_nodes.empty(); }
+
+private:
+	// Returns index of the newly created node in m_nodes.
+	size_t build_recursive(const BinaryTree &tree, size_t binary_node_idx)
+	{
+		size_t children[Arity];
+		int    num_children = 0;
+		const auto &binary_node = tree.node(binary_node_idx);
+		if (binary_node.is_leaf())
+			// Only the root of the binary tree gets here as a leaf.
+			children[num_children ++] = binary_node_idx;
+		else {
+			children[num_children ++] = binary_node_idx * 2 + 1;
+			children[num_children ++] = binary_node_idx * 2 + 2;
+			while (num_children < Arity) {
+				int    expand      = -1;
+				double expand_size = -1.;
+				for (int i = 0; i < num_children; ++ i)
+					if (const auto &n = tree.node(children[i]); n.is_inner()) {
+						double size = double((n.bbox.max() - n.bbox.min()).template cast<double>().squaredNorm());
+						if (size > expand_size) {
+							expand      = i;
+							expand_size = size;
+						}
+					}
+				if (expand == -1)
+					break;
+				size_t expanded = children[expand];
+				children[expand]            = expanded * 2 + 1;
+				children[num_children ++]   = expanded * 2 + 2;
+			}
+		}
+
+		size_t node_idx = m_nodes.size();
+		m_nodes.emplace_back();
+		{
+			Node &node = m_nodes.back();
+			for (int i = 0; i < Arity; ++ i) {
+				node.child[i] = npos;
+				for (int dim = 0; dim < NumDimensions; ++ dim) {
+					node.min[dim][i] = std::numeric_limits<CoordType>::max();
+					node.max[dim][i] = std::numeric_limits<CoordType>::lowest();
+				}
+			}
+			for (int i = 0; i < num_children; ++ i) {
+				const auto &child = tree.node(children[i]);
+				assert(child.is_valid());
+				for (int dim = 0; dim < NumDimensions; ++ dim) {
+					node.min[dim][i] = child.bbox.min()(dim);
+					node.max[dim][i] = child.bbox.max()(dim);
+				}
+				node.valid_mask |= uint32_t(1) << i;
+				if (child.is_leaf()) {
+					node.child[i]   = child.idx;
+					node.leaf_mask |= uint32_t(1) << i;
+				}
+			}
+		}
+		// Children are stored after their parent, m_nodes may reallocate while they are being built.
+		for (int i = 0; i < num_children; ++ i)
+			if (tree.node(children[i]).is_inner()) {
+				size_t child_idx = this->build_recursive(tree, children[i]);
+				m_nodes[node_idx].child[i] = child_idx;
+			}
+		return node_idx;
+	}
+
+	// The flattened tree storage, nodes in depth first order.
+	std::vector<Node> m_nodes;
+};
+
+using WideTree3f = WideTree<3, float>;
+using WideTree3d = WideTree<3, double>;
+
 // Wrap a 2D Slic3r own BoundingBox to be passed to Tree::build() and similar
 // to build an AABBTree over coord_t 2D bounding boxes.
 class BoundingBoxWrapper {
@@ -371,13 +536,15 @@ namespace detail {
 	template<typename V, typename W>
     std::enable_if_t<! std::is_same<typename V::Scalar, double>::value && std::is_same<typename W::Scalar, double>::value, bool>
 	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-        return intersect_triangle(origin.template cast<double>(), dir.template cast<double>(), v0, v1, v2, t, u, v, eps);
+        using Vec3dType = Eigen::Matrix<double, 3, 1, Eigen::DontAlign>;
+        return intersect_triangle(Vec3dType(origin.template cast<double>()), Vec3dType(dir.template cast<double>()), v0, v1, v2, t, u, v, eps);
 	}
 
 	template<typename V, typename W>
     std::enable_if_t<! std::is_same<typename V::Scalar, double>::value && ! std::is_same<typename W::Scalar, double>::value, bool>
 	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-	    return intersect_triangle(origin.template cast<double>(), dir.template cast<double>(), v0.template cast<double>(), v1.template cast<double>(), v2.template cast<double>(), t, u, v, eps);
+        using Vec3dType = Eigen::Matrix<double, 3, 1, Eigen::DontAlign>;
+	    return intersect_triangle(Vec3dType(origin.template cast<double>()), Vec3dType(dir.template cast<double>()), v0.template cast<double>(), v1.template cast<double>(), v2.template cast<double>(), t, u, v, eps);
 	}
 
 	template<typename Tree>
@@ -470,6 +637,158 @@ namespace detail {
 		}
 	}
 
+	// Packet of rays traced through the tree together, stored as a structure of arrays,
+	// so that a bounding box is tested against all the rays of the packet at once.
+	template<typename Scalar, size_t PacketSize>
+	struct RayPacket {
+		static_assert(PacketSize > 0 && PacketSize <= 32, "Ray packet size must fit a 32 bit mask");
+		alignas(32) Scalar origin[3][PacketSize];
+		alignas(32) Scalar invdir[3][PacketSize];
+		// Parameter of the closest hit found so far, rounded up to Scalar.
+		alignas(32) Scalar t[PacketSize];
+	};
+
+	// The min / max are written the way the SSE instructions are defined, so that the scalar fallback
+	// and the SIMD paths return the same results even for NaNs produced by rays parallel to a slab.
+	template<typename Scalar> inline Scalar packet_min(Scalar a, Scalar b) { return a < b ? a : b; }
+	template<typename Scalar> inline Scalar packet_max(Scalar a, Scalar b) { return a > b ? a : b; }
+
+	// Returns a mask of the active rays, which intersect the box closer than their closest hit so far.
+	template<typename Scalar, size_t PacketSize, typename BoxScalar>
+	inline uint32_t ray_packet_box_intersect(const RayPacket<Scalar, PacketSize> &packet, const Eigen::AlignedBox<BoxScalar, 3> &box, uint32_t active)
+	{
+		uint32_t mask = 0;
+		for (size_t i = 0; i < PacketSize; ++ i) {
+			Scalar tmin = Scalar(0);
+			Scalar tmax = packet.t[i];
+			for (int dim = 0; dim < 3; ++ dim) {
+				Scalar t0 = (Scalar(box.min()(dim)) - packet.origin[dim][i]) * packet.invdir[dim][i];
+				Scalar t1 = (Scalar(box.max()(dim)) - packet.origin[dim][i]) * packet.invdir[dim][i];
+				tmin = packet_max(tmin, packet_min(t0, t1));
+				tmax = packet_min(tmax, packet_max(t0, t1));
+			}
+			if (tmin <= tmax)
+				mask |= uint32_t(1) << i;
+		}
+		return mask & active;
+	}
+
+#ifdef SLIC3R_AABB_RAY_PACKET_SSE2
+	template<>
+	inline uint32_t ray_packet_box_intersect<float, 4, float>(const RayPacket<float, 4> &packet, const Eigen::AlignedBox<float, 3> &box, uint32_t active)
+	{
+		__m128 tmin = _mm_setzero_ps();
+		__m128 tmax = _mm_load_ps(packet.t);
+		for (int dim = 0; dim < 3; ++ dim) {
+			const __m128 origin = _mm_load_ps(packet.origin[dim]);
+			const __m128 invdir = _mm_load_ps(packet.invdir[dim]);
+			const __m128 t0     = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min()(dim)), origin), invdir);
+			const __m128 t1     = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max()(dim)), origin), invdir);
+			tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+			tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+		}
+		return uint32_t(_mm_movemask_ps(_mm_cmple_ps(tmin, tmax))) & active;
+	}
+#endif // SLIC3R_AABB_RAY_PACKET_SSE2
+
+#ifdef SLIC3R_AABB_RAY_PACKET_AVX
+	template<>
+	inline uint32_t ray_packet_box_intersect<float, 8, float>(const RayPacket<float, 8> &packet, const Eigen::AlignedBox<float, 3> &box, uint32_t active)
+	{
+		__m256 tmin = _mm256_setzero_ps();
+		__m256 tmax = _mm256_load_ps(packet.t);
+		for (int dim = 0; dim < 3; ++ dim) {
+			const __m256 origin = _mm256_load_ps(packet.origin[dim]);
+			const __m256 invdir = _mm256_load_ps(packet.invdir[dim]);
+			const __m256 t0     = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min()(dim)), origin), invdir);
+			const __m256 t1     = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max()(dim)), origin), invdir);
+			tmin = _mm256_max_ps(tmin, _mm256_min_ps(t0, t1));
+			tmax = _mm256_min_ps(tmax, _mm256_max_ps(t0, t1));
+		}
+		return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ))) & active;
+	}
+#endif // SLIC3R_AABB_RAY_PACKET_AVX
+
+	// Trace up to PacketSize rays through the tree at once, depth first with an explicit stack.
+	// A subtree is entered if any of the rays still active for its parent intersects its bounding box
+	// closer than the closest hit of that ray found so far. The triangles are intersected in double precision
+	// by the same routine as intersect_ray_first_hit() uses, one ray at a time.
+	// Returns a mask of the rays which hit a triangle.
+	template<size_t PacketSize, typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+	inline uint32_t intersect_ray_packet_first_hit(
+		const std::vector<VertexType> 		&vertices,
+		const std::vector<IndexedFaceType> 	&faces,
+		const TreeType 						&tree,
+		const VectorType					*origins,
+		const VectorType 					*dirs,
+		const size_t 						 num_rays,
+		igl::Hit 							*hits,
+		const double 						 eps)
+	{
+		using Scalar = typename VectorType::Scalar;
+		assert(num_rays > 0 && num_rays <= PacketSize);
+
+		RayPacket<Scalar, PacketSize> packet;
+		double                        hit_t[PacketSize];
+		for (size_t i = 0; i < PacketSize; ++ i) {
+			// The unused lanes replicate the first ray, they are masked out of the active rays.
+			const size_t ray = i < num_rays ? i : 0;
+			for (int dim = 0; dim < 3; ++ dim) {
+				packet.origin[dim][i] = origins[ray](dim);
+				packet.invdir[dim][i] = Scalar(1) / dirs[ray](dim);
+			}
+			packet.t[i] = std::numeric_limits<Scalar>::infinity();
+			hit_t[i]    = std::numeric_limits<double>::infinity();
+		}
+
+		const uint32_t all_rays = num_rays == 32 ? uint32_t(-1) : (uint32_t(1) << num_rays) - 1;
+		uint32_t       hit_mask = 0;
+		if (tree.empty())
+			return hit_mask;
+
+		// The tree is balanced, its depth is bounded by the number of bits of the node index.
+		std::pair<size_t, uint32_t> stack[sizeof(size_t) * 8 * 2];
+		size_t                      stack_size = 0;
+		stack[stack_size ++] = { size_t(0), all_rays };
+		while (stack_size > 0) {
+			const auto [node_idx, parent_mask] = stack[-- stack_size];
+			const auto &node = tree.node(node_idx);
+			assert(node.is_valid());
+			const uint32_t mask = ray_packet_box_intersect(packet, node.bbox, parent_mask);
+			if (mask == 0)
+				continue;
+			if (node.is_leaf()) {
+				const auto &face = faces[node.idx];
+				for (uint32_t bits = mask; bits != 0; bits &= bits - 1) {
+					size_t ray = 0;
+					while (((bits >> ray) & 1) == 0)
+						++ ray;
+					double t, u, v;
+					if (intersect_triangle(origins[ray], dirs[ray], vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps) &&
+						t > 0. && t < hit_t[ray]) {
+						hits[ray]       = igl::Hit{ int(node.idx), -1, float(u), float(v), float(t) };
+						hit_t[ray]      = t;
+						packet.t[ray]   = std::nextafter(Scalar(t), std::numeric_limits<Scalar>::infinity());
+						hit_mask       |= uint32_t(1) << ray;
+					}
+				}
+			} else {
+				// Visit the child closer to the origin along the first active ray first, so that the closest hits
+				// are likely found early and the farther subtree gets culled.
+				size_t left  = node_idx * 2 + 1;
+				size_t right = left + 1;
+				size_t ray   = 0;
+				while (((mask >> ray) & 1) == 0)
+					++ ray;
+				if ((tree.node(right).bbox.center() - tree.node(left).bbox.center()).template cast<Scalar>().dot(dirs[ray]) < 0)
+					std::swap(left, right);
+				stack[stack_size ++] = { right, mask };
+				stack[stack_size ++] = { left,  mask };
+			}
+		}
+		return hit_mask;
+	}
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -692,24 +1011,24 @@ inline Tree<3, typename VertexType::Scalar> build_aabb_tree_over_indexed_triangl
         VectorType 	m_centroid;
 	};
 
-	std::vector<InputType> input;
-	input.reserve(faces.size());
+	std::vector<InputType> input(faces.size());
     const VectorType veps(eps, eps, eps);
-	for (size_t i = 0; i < faces.size(); ++ i) {
-        const IndexedFaceType &face = faces[i];
-		const VertexType &v1 = vertices[face(0)];
-		const VertexType &v2 = vertices[face(1)];
-		const VertexType &v3 = vertices[face(2)];
-		InputType n;
-        n.m_idx      = i;
-        n.m_centroid = (1./3.) * (v1 + v2 + v3);
-        n.m_bbox = BoundingBox(v1, v1);
-        n.m_bbox.extend(v2);
-        n.m_bbox.extend(v3);
-        n.m_bbox.min() -= veps;
-        n.m_bbox.max() += veps;
-        input.emplace_back(n);
-	}
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, faces.size(), 4096), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const IndexedFaceType &face = faces[i];
+            const VertexType &v1 = vertices[face(0)];
+            const VertexType &v2 = vertices[face(1)];
+            const VertexType &v3 = vertices[face(2)];
+            InputType &n = input[i];
+            n.m_idx      = i;
+            n.m_centroid = (1./3.) * (v1 + v2 + v3);
+            n.m_bbox = BoundingBox(v1, v1);
+            n.m_bbox.extend(v2);
+            n.m_bbox.extend(v3);
+            n.m_bbox.min() -= veps;
+            n.m_bbox.max() += veps;
+        }
+    });
 
 	TreeType out;
 	out.build(std::move(input));
@@ -787,6 +1106,43 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Number of rays traced together by intersect_rays_first_hit(), matching the SIMD width of the target for float rays.
+#ifdef SLIC3R_AABB_RAY_PACKET_AVX
+static constexpr size_t ray_packet_size = 8;
+#else
+static constexpr size_t ray_packet_size = 4;
+#endif
+
+// Find the first intersections of a stream of rays with indexed triangle set.
+// The rays are traced through the tree in packets of PacketSize, bounding boxes being tested against all rays
+// of a packet at once. With float rays and the default packet size, the box tests are done with SSE2 or AVX.
+// Tracing a packet pays off if the rays are coherent, for example rays shot from a single point into a hemisphere.
+// The ray-triangle intersection is calculated in double precision as with intersect_ray_first_hit().
+// Output hits[i] has id < 0 if the i-th ray does not hit the mesh.
+template<size_t PacketSize = ray_packet_size, typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline void intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const std::vector<VectorType>		&origins,
+	// Directions of the rays.
+	const std::vector<VectorType>		&dirs,
+	// First intersection of each ray with the indexed triangle set.
+	std::vector<igl::Hit> 				&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	assert(origins.size() == dirs.size());
+	hits.assign(origins.size(), igl::Hit{ -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() });
+	for (size_t begin = 0; begin < origins.size(); begin += PacketSize)
+		detail::intersect_ray_packet_first_hit<PacketSize>(vertices, faces, tree, origins.data() + begin, dirs.data() + begin,
+			std::min(PacketSize, origins.size() - begin), hits.data() + begin, eps);
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
@@ -875,6 +1231,248 @@ inline std::vector<size_t> all_triangles_in_radius(
 	return found_triangles;
 }
 
+namespace detail {
+	// Index of the lowest set bit of a non-zero mask.
+	inline int mask_lowest_bit(uint32_t mask)
+	{
+		assert(mask != 0);
+		int i = 0;
+		while (((mask >> i) & 1) == 0)
+			++ i;
+		return i;
+	}
+
+	// Returns a mask of the children of a WideTree node, whose bounding boxes the ray intersects at a parameter in <0, t_max>.
+	// Ray parameters at which the ray enters the children bounding boxes are stored into tmin_out.
+	template<typename CoordType, int Arity, typename VectorType>
+	inline uint32_t ray_wide_node_intersect(
+		const typename WideTree<3, CoordType, Arity>::Node 	&node,
+		const VectorType 									&origin,
+		const VectorType 									&invdir,
+		const typename VectorType::Scalar 					 t_max,
+		typename VectorType::Scalar 						*tmin_out)
+	{
+		using Scalar = typename VectorType::Scalar;
+		Scalar tmax[Arity];
+		for (int i = 0; i < Arity; ++ i) {
+			tmin_out[i] = Scalar(0);
+			tmax[i]     = t_max;
+		}
+		for (int dim = 0; dim < 3; ++ dim)
+			for (int i = 0; i < Arity; ++ i) {
+				Scalar t0 = (Scalar(node.min[dim][i]) - origin(dim)) * invdir(dim);
+				Scalar t1 = (Scalar(node.max[dim][i]) - origin(dim)) * invdir(dim);
+				tmin_out[i] = packet_max(tmin_out[i], packet_min(t0, t1));
+				tmax[i]     = packet_min(tmax[i], packet_max(t0, t1));
+			}
+		uint32_t mask = 0;
+		for (int i = 0; i < Arity; ++ i)
+			if (tmin_out[i] <= tmax[i])
+				mask |= uint32_t(1) << i;
+		return mask & node.valid_mask;
+	}
+
+	// Push the inner children of a WideTree node selected by mask onto a traversal stack, the one with the lowest key
+	// ends up on the top of the stack.
+	template<typename CoordType, int Arity, typename Scalar>
+	inline void wide_push_children_sorted(
+		const typename WideTree<3, CoordType, Arity>::Node 	&node,
+		uint32_t 											 mask,
+		const Scalar 										*keys,
+		std::pair<size_t, Scalar> 							*stack,
+		size_t 												&stack_size)
+	{
+		int order[Arity];
+		int num = 0;
+		for (; mask != 0; mask &= mask - 1) {
+			// Insertion sort by the key descending.
+			int i = mask_lowest_bit(mask);
+			int j = num ++;
+			for (; j > 0 && keys[order[j - 1]] < keys[i]; -- j)
+				order[j] = order[j - 1];
+			order[j] = i;
+		}
+		for (int k = 0; k < num; ++ k)
+			stack[stack_size ++] = { node.child[order[k]], keys[order[k]] };
+	}
+
+	// Depth of the WideTree is bounded by the number of bits of the node index, each visited level pushes less than Arity nodes.
+	template<int Arity> constexpr size_t wide_stack_size = sizeof(size_t) * 8 * Arity;
+
+	template<typename VertexType, typename IndexedFaceType, typename CoordType, int Arity, typename VectorType, typename HitFn>
+	inline void intersect_ray_wide(
+		const std::vector<VertexType> 			&vertices,
+		const std::vector<IndexedFaceType> 		&faces,
+		const WideTree<3, CoordType, Arity> 	&tree,
+		const VectorType						&origin,
+		const VectorType 						&dir,
+		const double 							 eps,
+		// Returns true if only the hits closer than this hit shall be reported from now on.
+		HitFn 									&&hit_fn)
+	{
+		using Scalar = typename VectorType::Scalar;
+		const VectorType invdir = dir.cwiseInverse();
+		Scalar 			 t_max  = std::numeric_limits<Scalar>::infinity();
+		Scalar 			 tmin[Arity];
+		std::pair<size_t, Scalar> stack[wide_stack_size<Arity>];
+		size_t 			 stack_size = 0;
+		stack[stack_size ++] = { size_t(0), Scalar(0) };
+		while (stack_size > 0) {
+			const auto [node_idx, node_tmin] = stack[-- stack_size];
+			if (node_tmin > t_max)
+				continue;
+			const auto    &node = tree.node(node_idx);
+			const uint32_t mask = ray_wide_node_intersect<CoordType, Arity>(node, origin, invdir, t_max, tmin);
+			for (uint32_t bits = mask & node.leaf_mask; bits != 0; bits &= bits - 1) {
+				const size_t idx  = node.child[mask_lowest_bit(bits)];
+				const auto  &face = faces[idx];
+				double t, u, v;
+				if (intersect_triangle(origin, dir, vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps) && t > 0. &&
+					hit_fn(igl::Hit{ int(idx), -1, float(u), float(v), float(t) }, t))
+					t_max = std::nextafter(Scalar(t), std::numeric_limits<Scalar>::infinity());
+			}
+			wide_push_children_sorted<CoordType, Arity>(node, mask & ~node.leaf_mask, tmin, stack, stack_size);
+		}
+	}
+
+	template<typename VertexType, typename IndexedFaceType, typename CoordType, int Arity, typename VectorType>
+	inline bool squared_distance_wide(
+		const std::vector<VertexType> 			&vertices,
+		const std::vector<IndexedFaceType> 		&faces,
+		const WideTree<3, CoordType, Arity> 	&tree,
+		const VectorType						&point,
+		typename VectorType::Scalar 			&up_sqr_d,
+		size_t 									&hit_idx_out,
+		Eigen::PlainObjectBase<VectorType>		&hit_point_out)
+	{
+		using Scalar = typename VectorType::Scalar;
+		bool   found = false;
+		Scalar sqr_d[Arity];
+		std::pair<size_t, Scalar> stack[wide_stack_size<Arity>];
+		size_t stack_size = 0;
+		stack[stack_size ++] = { size_t(0), Scalar(0) };
+		while (stack_size > 0) {
+			const auto [node_idx, node_sqr_d] = stack[-- stack_size];
+			if (node_sqr_d > up_sqr_d)
+				continue;
+			const auto &node = tree.node(node_idx);
+			for (int i = 0; i < Arity; ++ i)
+				sqr_d[i] = Scalar(0);
+			for (int dim = 0; dim < 3; ++ dim)
+				for (int i = 0; i < Arity; ++ i) {
+					Scalar d = packet_max(Scalar(0), packet_max(Scalar(node.min[dim][i]) - point(dim), point(dim) - Scalar(node.max[dim][i])));
+					sqr_d[i] += d * d;
+				}
+			uint32_t mask = 0;
+			for (int i = 0; i < Arity; ++ i)
+				if (sqr_d[i] <= up_sqr_d)
+					mask |= uint32_t(1) << i;
+			mask &= node.valid_mask;
+			for (uint32_t bits = mask & node.leaf_mask; bits != 0; bits &= bits - 1) {
+				const size_t idx  = node.child[mask_lowest_bit(bits)];
+				const auto  &face = faces[idx];
+				VectorType c = closest_point_to_triangle<VectorType>(point,
+					vertices[face(0)].template cast<Scalar>(), vertices[face(1)].template cast<Scalar>(), vertices[face(2)].template cast<Scalar>());
+				Scalar d = (point - c).squaredNorm();
+				if (d < up_sqr_d) {
+					up_sqr_d      = d;
+					hit_idx_out   = idx;
+					hit_point_out = c;
+					found         = true;
+				}
+			}
+			wide_push_children_sorted<CoordType, Arity>(node, mask & ~node.leaf_mask, sqr_d, stack, stack_size);
+		}
+		return found;
+	}
+} // namespace detail
+
+// Build a WideTree over an indexed triangle set by flattening the balanced binary Tree.
+template<int Arity = 4, typename VertexType, typename IndexedFaceType>
+inline WideTree<3, typename VertexType::Scalar, Arity> build_wide_aabb_tree_over_indexed_triangle_set(
+	const std::vector<VertexType> 		&vertices,
+    const std::vector<IndexedFaceType> 	&faces,
+    const typename VertexType::Scalar 	 eps = 0)
+{
+	return WideTree<3, typename VertexType::Scalar, Arity>(build_aabb_tree_over_indexed_triangle_set(vertices, faces, eps));
+}
+
+// intersect_ray_first_hit() over a WideTree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, int Arity, typename VectorType>
+inline bool intersect_ray_first_hit(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<3, CoordType, Arity> &tree,
+	const VectorType					&origin,
+	const VectorType 					&dir,
+	igl::Hit 							&hit,
+	const double 						 eps = 0.000001)
+{
+	double min_t = std::numeric_limits<double>::infinity();
+	if (! tree.empty())
+		detail::intersect_ray_wide(vertices, faces, tree, origin, dir, eps, [&hit, &min_t](const igl::Hit &new_hit, double t) {
+			if (t >= min_t)
+				return false;
+			min_t = t;
+			hit   = new_hit;
+			return true;
+		});
+	return min_t < std::numeric_limits<double>::infinity();
+}
+
+// intersect_ray_all_hits() over a WideTree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, int Arity, typename VectorType>
+inline bool intersect_ray_all_hits(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<3, CoordType, Arity> &tree,
+	const VectorType					&origin,
+	const VectorType 					&dir,
+	std::vector<igl::Hit> 				&hits,
+	const double 						 eps = 0.000001)
+{
+	hits.clear();
+	if (! tree.empty()) {
+		detail::intersect_ray_wide(vertices, faces, tree, origin, dir, eps, [&hits](const igl::Hit &hit, double) {
+			hits.emplace_back(hit);
+			return false;
+		});
+	    std::sort(hits.begin(), hits.end(), [](const auto &l, const auto &r) { return l.t < r.t; });
+	}
+	return ! hits.empty();
+}
+
+// squared_distance_to_indexed_triangle_set() over a WideTree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, int Arity, typename VectorType>
+inline typename VectorType::Scalar squared_distance_to_indexed_triangle_set(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<3, CoordType, Arity> &tree,
+	const VectorType					&point,
+	size_t 								&hit_idx_out,
+	Eigen::PlainObjectBase<VectorType>	&hit_point_out)
+{
+    using Scalar = typename VectorType::Scalar;
+    Scalar sqr_d = std::numeric_limits<Scalar>::infinity();
+    return tree.empty() ? Scalar(-1) :
+    	detail::squared_distance_wide(vertices, faces, tree, point, sqr_d, hit_idx_out, hit_point_out) ? sqr_d : Scalar(-1);
+}
+
+// is_any_triangle_in_radius() over a WideTree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, int Arity, typename VectorType>
+inline bool is_any_triangle_in_radius(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<3, CoordType, Arity> &tree,
+	const VectorType					&point,
+	typename VectorType::Scalar 		&max_distance_squared)
+{
+	size_t 	   hit_idx;
+	VectorType hit_point;
+	typename VectorType::Scalar sqr_d = max_distance_squared;
+	return ! tree.empty() && detail::squared_distance_wide(vertices, faces, tree, point, sqr_d, hit_idx, hit_point);
+}
+
 
 // Traverse the tree and return the index of an entity whose bounding box
 // contains a given point. Returns size_t(-1) when the point is outside.
@@ -901,6 +1499,33 @@ void get_candidate_idxs(const TreeType& tree, const VectorType& v, std::vector<s
     return;
 }
 
+// get_candidate_idxs() over a WideTree.
+template<int NumDimensions, typename CoordType, int Arity, typename VectorType>
+void get_candidate_idxs(const WideTree<NumDimensions, CoordType, Arity> &tree, const VectorType &v, std::vector<size_t> &candidates)
+{
+    if (tree.empty())
+        return;
+
+    size_t stack[detail::wide_stack_size<Arity>];
+    size_t stack_size = 0;
+    stack[stack_size ++] = 0;
+    while (stack_size > 0) {
+        const auto &node = tree.node(stack[-- stack_size]);
+        uint32_t    mask = node.valid_mask;
+        for (int dim = 0; dim < NumDimensions; ++ dim)
+            for (int i = 0; i < Arity; ++ i)
+                if (v(dim) < node.min[dim][i] || v(dim) > node.max[dim][i])
+                    mask &= ~(uint32_t(1) << i);
+        for (; mask != 0; mask &= mask - 1) {
+            int i = detail::mask_lowest_bit(mask);
+            if (node.is_leaf(i))
+                candidates.push_back(node.child[i]);
+            else
+                stack[stack_size ++] = node.child[i];
+        }
+    }
+}
+
 // Predicate: need to be specialized for intersections of different geomteries
 template<class G> struct Intersecting {};
 
@@ -1657,8 +1657,14 @@ void ConfigBase::null_nullables()
 
 DynamicConfig::DynamicConfig(const ConfigBase& rhs, const t_config_option_keys& keys)
 {
+	t_options_map::sequence_type opts;
+	opts.reserve(keys.size());
 	for (const t_config_option_key& opt_key : keys)
-		this->options[opt_key] = std::unique_ptr<ConfigOption>(rhs.option(opt_key)->clone());
+		opts.emplace_back(opt_key, std::unique_ptr<ConfigOption>(rhs.option(opt_key)->clone()));
+	// Sort the options at once instead of inserting them one by one into the flat storage.
+	std::stable_sort(opts.begin(), opts.end(), [](const auto &l, const auto &r) { return l.first < r.first; });
+	opts.erase(std::unique(opts.begin(), opts.end(), [](const auto &l, const auto &r) { return l.first == r.first; }), opts.end());
+	this->options.adopt_sequence(boost::container::ordered_unique_range, std::move(opts));
 }
 
 bool DynamicConfig::operator==(const DynamicConfig &rhs) const
@@ -1879,8 +1885,8 @@ t_config_option_keys StaticConfig::keys() const
 template<typename Fn>
 static inline bool dynamic_config_iterate(const DynamicConfig &lhs, const DynamicConfig &rhs, Fn fn, const std::set<std::string>* skipped_keys = nullptr)
 {
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator i = lhs.cbegin();
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator j = rhs.cbegin();
+    DynamicConfig::t_options_map::const_iterator i = lhs.cbegin();
+    DynamicConfig::t_options_map::const_iterator j = rhs.cbegin();
     while (i != lhs.cend() && j != rhs.cend())
         if (i->first < j->first)
             ++ i;
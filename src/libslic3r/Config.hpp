@@ -4,17 +4,21 @@
 #include <assert.h>
 #include <map>
 #include <climits>
+#include <algorithm>
+#include <iterator>
 #include "clonable_ptr.hpp"
 #include "Exception.hpp"
 #include "Point.hpp"
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/container/flat_map.hpp>
 #include <boost/format/format_fwd.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/property_tree/ptree_fwd.hpp>
 
 #include <cereal/access.hpp>
+#include <cereal/cereal.hpp>
 #include <cereal/types/base_class.hpp>
 
 namespace Slic3r {
@@ -2195,8 +2199,10 @@ public:
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
         this->clear();
+        // rhs.options is sorted already, thus the options are appended in linear time.
+        this->options.reserve(rhs.options.size());
         for (const auto &kvp : rhs.options)
-            this->options[kvp.first].reset(kvp.second->clone());
+            this->options.emplace_hint(this->options.end(), kvp.first, std::unique_ptr<ConfigOption>(kvp.second->clone()));
         return *this;
     }
 
@@ -2216,10 +2222,13 @@ public:
     DynamicConfig& operator+=(const DynamicConfig &rhs)
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
+        // Options missing in this config are collected in key order and merged in a single pass,
+        // inserting them one by one into the flat storage would be quadratic.
+        t_options_map::sequence_type missing;
         for (const auto &kvp : rhs.options) {
             auto it = this->options.find(kvp.first);
             if (it == this->options.end())
-                this->options[kvp.first].reset(kvp.second->clone());
+                missing.emplace_back(kvp.first, std::unique_ptr<ConfigOption>(kvp.second->clone()));
             else {
                 assert(it->second->type() == kvp.second->type());
                 if (it->second->type() == kvp.second->type())
@@ -2228,6 +2237,7 @@ public:
                     it->second.reset(kvp.second->clone());
             }
         }
+        this->merge_sorted(std::move(missing));
         return *this;
     }
 
@@ -2236,15 +2246,17 @@ public:
     DynamicConfig& operator+=(DynamicConfig &&rhs)
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
+        t_options_map::sequence_type missing;
         for (auto &kvp : rhs.options) {
             auto it = this->options.find(kvp.first);
             if (it == this->options.end()) {
-                this->options.insert(std::make_pair(kvp.first, std::move(kvp.second)));
+                missing.emplace_back(kvp.first, std::move(kvp.second));
             } else {
                 assert(it->second->type() == kvp.second->type());
                 it->second = std::move(kvp.second);
             }
         }
+        this->merge_sorted(std::move(missing));
         rhs.options.clear();
         return *this;
     }
@@ -2340,15 +2352,33 @@ public:
     // Command line processing
     bool                read_cli(int argc, const char* const argv[], t_config_option_keys* extra, t_config_option_keys* keys = nullptr);
 
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator cbegin() const { return options.cbegin(); }
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator cend()   const { return options.cend(); }
-    size_t                        												 size()   const { return options.size(); }
+    // Options are stored in a flat vector sorted by their keys: lookups are binary searches over contiguous memory
+    // and equals() / diff() / equal() are linear merge walks over two such vectors.
+    using t_options_map = boost::container::flat_map<t_config_option_key, std::unique_ptr<ConfigOption>>;
+
+    t_options_map::const_iterator cbegin() const { return options.cbegin(); }
+    t_options_map::const_iterator cend()   const { return options.cend(); }
+    size_t                        size()   const { return options.size(); }
 
 private:
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>> options;
+    // Merge options sorted by their keys, none of them being present in this->options yet.
+    void merge_sorted(t_options_map::sequence_type &&sorted)
+    {
+        if (sorted.empty())
+            return;
+        t_options_map::sequence_type merged;
+        {
+            t_options_map::sequence_type old = this->options.extract_sequence();
+            merged.reserve(old.size() + sorted.size());
+            std::merge(std::make_move_iterator(old.begin()), std::make_move_iterator(old.end()),
+                std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()),
+                std::back_inserter(merged), [](const auto &l, const auto &r) { return l.first < r.first; });
+        }
+        this->options.adopt_sequence(boost::container::ordered_unique_range, std::move(merged));
+    }
+
+    t_options_map options;
 
-	friend class cereal::access;
-	template<class Archive> void serialize(Archive &ar) { ar(options); }
 };
 
 // Configuration store with a static definition of configuration values.
@@ -2369,4 +2399,33 @@ protected:
 
 }
 
+// Serialization through the Cereal library
+namespace cereal {
+    // Let cereal know that there are load / save non-member functions declared for DynamicConfig.
+    // Member load / save templates would hide ConfigBase::load() / ConfigBase::save() of a file or a property tree.
+    template <class Archive> struct specialize<Archive, Slic3r::DynamicConfig, cereal::specialization::non_member_load_save> {};
+
+    // Stored in the same layout as cereal stores std::map, so that the serialized snapshots do not change.
+    template<class Archive> void save(Archive &ar, const Slic3r::DynamicConfig &config)
+    {
+        ar(cereal::make_size_tag(static_cast<cereal::size_type>(config.size())));
+        for (auto it = config.cbegin(); it != config.cend(); ++ it)
+            ar(it->first, it->second);
+    }
+
+    template<class Archive> void load(Archive &ar, Slic3r::DynamicConfig &config)
+    {
+        cereal::size_type cnt;
+        ar(cereal::make_size_tag(cnt));
+        config.clear();
+        for (cereal::size_type i = 0; i < cnt; ++ i) {
+            Slic3r::t_config_option_key           key;
+            std::unique_ptr<Slic3r::ConfigOption> opt;
+            ar(key, opt);
+            // The keys were stored sorted, thus each option is appended to the end of the flat map.
+            config.set_key_value(key, opt.release());
+        }
+    }
+}
+
 #endif
@@ -148,7 +148,7 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 			m_bbox.merge(pt);
 	}
 
-	coord_t eps = 16;
+	coord_t eps = bbox_margin;
 	m_bbox.min(0) -= eps;
 	m_bbox.min(1) -= eps;
 	m_bbox.max(0) += eps;
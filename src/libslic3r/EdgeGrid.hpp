@@ -90,6 +90,9 @@ private:
 class Grid
 {
 public:
+	// Margin, by which create() extends the bounding box of the contours.
+	static constexpr coord_t bbox_margin = 16;
+
 	Grid() = default;
 	Grid(const BoundingBox &bbox) : m_bbox(bbox) {}
 
@@ -20,6 +20,8 @@
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
 #include <boost/geometry/geometries/segment.hpp>
@@ -235,14 +237,23 @@ static constexpr std::array<std::array<int, 8>, 3> child_traversal_order {
     std::array<int, 8>{ 1, 5, 0, 4, 3, 7, 2, 6 },
 };
 
+// Cube of an octree under construction, see OctreeBuilder.
 struct Cube
+{
+    Vec3d center;
+    std::array<Cube*, 8> children {}; // initialized to nullptrs
+    Cube(const Vec3d &center) : center(center) {}
+};
+
+// Cube of a finished octree, stored in Octree::cubes in depth first order.
+struct CompactCube
 {
     Vec3d center;
 #ifndef NDEBUG
     Vec3d center_octree;
 #endif // NDEBUG
-    std::array<Cube*, 8> children {}; // initialized to nullptrs
-    Cube(const Vec3d &center) : center(center) {}
+    // Indices of the children in Octree::cubes, zero if there is no such child (the root cube is nobody's child).
+    std::array<uint32_t, 8> children {};
 };
 
 struct CubeProperties
@@ -256,17 +267,15 @@ struct CubeProperties
 
 struct Octree
 {
-    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
-    // perfect for building up our octree.
-    boost::object_pool<Cube>    pool;
-    Cube*                       root_cube { nullptr };
+    // Cubes without pointers, the root cube first, each cube followed by its subtrees for cache efficient traversal.
+    std::vector<CompactCube>    cubes;
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
 
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
-        : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
+        : origin(origin), cubes_properties(cubes_properties) {}
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    const CompactCube&          root_cube() const { return cubes.front(); }
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -368,6 +377,7 @@ struct FillContext
     };
 
     FillContext(const Octree &octree, double z_position, int direction_idx) :
+        cubes(octree.cubes),
         cubes_properties(octree.cubes_properties),
         z_position(z_position),
         traversal_order(child_traversal_order[direction_idx]),
@@ -381,6 +391,7 @@ struct FillContext
     // Rotate the point, uses the same convention as Point::rotate().
     Vec2d rotate(const Vec2d& v) { return Vec2d(this->cos_a * v.x() - this->sin_a * v.y(), this->sin_a * v.x() + this->cos_a * v.y()); }
 
+    const std::vector<CompactCube>     &cubes;
     const std::vector<CubeProperties>  &cubes_properties;
     // Top of the current layer.
     const double                        z_position;
@@ -413,9 +424,9 @@ Eigen::Quaterniond transform_to_octree()
 // Verify that the traversal order of the octree children matches the line direction,
 // therefore the infill line may get extended with O(1) time & space complexity.
 static bool verify_traversal_order(
-    FillContext  &context,
-    const Cube   *cube,
-    int           depth,
+    FillContext        &context,
+    const CompactCube  &cube,
+    int                 depth,
     const Vec2d  &line_from,
     const Vec2d  &line_to)
 {
@@ -423,8 +434,8 @@ static bool verify_traversal_order(
     Eigen::Quaterniond to_world = transform_to_world();
     for (int i = 0; i < 8; ++i) {
         int j = context.traversal_order[i];
-        Vec3d cntr = to_world * (cube->center_octree + (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.)));
-        assert(!cube->children[j] || cube->children[j]->center.isApprox(cntr));
+        Vec3d cntr = to_world * (cube.center_octree + (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.)));
+        assert(!cube.children[j] || context.cubes[cube.children[j]].center.isApprox(cntr));
         c[i] = cntr;
     }
     std::array<Vec3d, 10> dirs = {
@@ -447,16 +458,14 @@ static bool verify_traversal_order(
 #endif // NDEBUG
 
 static void generate_infill_lines_recursive(
-    FillContext     &context,
-    const Cube      *cube,
+    FillContext        &context,
+    const CompactCube  &cube,
     // Address of this wall in the octree,  used to address context.temp_lines.
-    int              address,
-    int              depth)
+    int                 address,
+    int                 depth)
 {
-    assert(cube != nullptr);
-
     const std::vector<CubeProperties> &cubes_properties = context.cubes_properties;
-    const double z_diff     = context.z_position - cube->center.z();
+    const double z_diff     = context.z_position - cube.center.z();
     const double z_diff_abs = std::abs(z_diff);
 
     if (z_diff_abs > cubes_properties[depth].height / 2.)
@@ -472,7 +481,7 @@ static void generate_infill_lines_recursive(
         from = context.rotate(from);
         to   = context.rotate(to);
         // Relative to cube center
-        const Vec2d offset(cube->center.x(), cube->center.y());
+        const Vec2d offset(cube.center.x(), cube.center.y());
         from += offset;
         to   += offset;
         // Verify that the traversal order of the octree children matches the line direction,
@@ -495,9 +504,8 @@ static void generate_infill_lines_recursive(
     -- depth;
     size_t i = 0;
     for (const int child_idx : context.traversal_order) {
-        const Cube *child = cube->children[child_idx];
-        if (child != nullptr)
-            generate_infill_lines_recursive(context, child, address, depth);
+        if (const uint32_t child = cube.children[child_idx]; child != 0)
+            generate_infill_lines_recursive(context, context.cubes[child], address, depth);
         if (++ i == 4)
             // right child index
             ++ address;
@@ -1337,7 +1345,7 @@ void Filler::_fill_surface_single(
         // Generate the infill lines along the octree cells, merge touching lines of the same direction.
         size_t num_lines = 0;
         for (auto &context : contexts) {
-            generate_infill_lines_recursive(context, adapt_fill_octree->root_cube, 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
+            generate_infill_lines_recursive(context, adapt_fill_octree->root_cube(), 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
             num_lines += context.output_lines.size() + context.temp_lines.size();
         }
 
@@ -1452,17 +1460,65 @@ static inline bool is_overhang_triangle(const Vec3d &a, const Vec3d &b, const Ve
     return n.dot(up) > 0.707 * n.norm();
 }
 
-static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
+// Slightly expanded bounding box of a child cube of a cube with the given center and bounding box,
+// to cope with triangles touching a cube wall and other numeric errors.
+// We will rather densify the octree a bit more than necessary instead of missing a triangle.
+static inline BoundingBoxf3 child_bbox(const Vec3d &center, const BoundingBoxf3 &bbox, int child_idx)
 {
-#ifndef NDEBUG
-    current_cube->center_octree = current_cube->center;
-#endif // NDEBUG
-    current_cube->center = rot * current_cube->center;
-    for (auto *child : current_cube->children)
-        if (child)
-            transform_center(child, rot);
+    const Vec3d  &child_center_dir = child_centers[child_idx];
+    BoundingBoxf3 out;
+    for (int k = 0; k < 3; ++ k) {
+        if (child_center_dir[k] == -1.) {
+            out.min[k] = bbox.min[k];
+            out.max[k] = center[k] + EPSILON;
+        } else {
+            out.min[k] = center[k] - EPSILON;
+            out.max[k] = bbox.max[k];
+        }
+    }
+    return out;
+}
+
+// Octree under construction. Triangles are inserted into the cubes linked by pointers,
+// the finished octree is compacted into Octree::cubes.
+struct OctreeBuilder
+{
+    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
+    // perfect for building up our octree. The pool is not thread safe, thus subtrees built in parallel
+    // allocate their Cubes from pools of their own.
+    using Pool = boost::object_pool<Cube>;
+    std::vector<std::unique_ptr<Pool>>  pools;
+    Cube*                               root_cube { nullptr };
+    const std::vector<CubeProperties>  &cubes_properties;
+
+    OctreeBuilder(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties) : cubes_properties(cubes_properties)
+    {
+        pools.emplace_back(std::make_unique<Pool>());
+        root_cube = pools.front()->construct(origin);
+    }
+
+    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth, Pool &pool) const;
+
+    // Store the subtree of cube into out in depth first order, return index of cube in out.
+    static uint32_t compact(const Cube *cube, std::vector<CompactCube> &out);
+};
+
+uint32_t OctreeBuilder::compact(const Cube *cube, std::vector<CompactCube> &out)
+{
+    const auto idx = uint32_t(out.size());
+    out.push_back({ cube->center });
+    for (int i = 0; i < 8; ++ i)
+        if (cube->children[i]) {
+            const uint32_t child = compact(cube->children[i], out);
+            out[idx].children[i] = child;
+        }
+    return idx;
 }
 
+// Number of levels of the octree below the root cube, whose cubes are created by a parallel classification
+// of the triangles. Subtrees below them are built in parallel.
+static constexpr int octree_parallel_levels = 2;
+
 OctreePtr build_octree(
     // Mesh is rotated to the coordinate system of the octree.
     const indexed_triangle_set  &triangle_mesh,
@@ -1479,41 +1535,112 @@ OctreePtr build_octree(
     Vec3d                       cube_center      = bbox.center().cast<double>();
     std::vector<CubeProperties> cubes_properties = make_cubes_properties(double(bbox.size().maxCoeff()), line_spacing);
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
+    OctreeBuilder               builder(cube_center, octree->cubes_properties);
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
         double edge_length_half = 0.5 * cubes_properties.back().edge_length;
         Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
         int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
-        };
+        const BoundingBoxf3 root_bbox(builder.root_cube->center - diag_half, builder.root_cube->center + diag_half);
         auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            Vec3d a = triangle_mesh.vertices[tri[0]].cast<double>();
-            Vec3d b = triangle_mesh.vertices[tri[1]].cast<double>();
-            Vec3d c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
+        // Triangles of the mesh followed by the overhang triangles.
+        const size_t num_mesh_triangles = triangle_mesh.indices.size();
+        const size_t num_triangles      = num_mesh_triangles + overhang_triangles.size() / 3;
+        auto triangle = [&triangle_mesh, &overhang_triangles, num_mesh_triangles](size_t idx) -> std::array<Vec3d, 3> {
+            if (idx < num_mesh_triangles) {
+                const auto &tri = triangle_mesh.indices[idx];
+                return { triangle_mesh.vertices[tri[0]].cast<double>(), triangle_mesh.vertices[tri[1]].cast<double>(), triangle_mesh.vertices[tri[2]].cast<double>() };
+            }
+            idx = (idx - num_mesh_triangles) * 3;
+            return { overhang_triangles[idx], overhang_triangles[idx + 1], overhang_triangles[idx + 2] };
+        };
+        auto inserted = [support_overhangs_only, &up_vector, num_mesh_triangles](size_t idx, const std::array<Vec3d, 3> &tri) {
+            return idx >= num_mesh_triangles || ! support_overhangs_only || is_overhang_triangle(tri[0], tri[1], tri[2], up_vector);
+        };
+
+        if (max_depth < octree_parallel_levels) {
+            for (size_t idx = 0; idx < num_triangles; ++ idx)
+                if (const std::array<Vec3d, 3> tri = triangle(idx); inserted(idx, tri))
+                    builder.insert_triangle(tri[0], tri[1], tri[2], builder.root_cube, root_bbox, max_depth, *builder.pools.front());
+        } else {
+            // Cubes of the top levels, addressed by the indices of the children at both levels, and their bounding boxes.
+            static_assert(octree_parallel_levels == 2, "The top levels are addressed by 64 bit masks.");
+            std::array<Vec3d, 8>          level1_centers;
+            std::array<BoundingBoxf3, 8>  level1_bboxes;
+            std::array<Vec3d, 64>         top_centers;
+            std::array<BoundingBoxf3, 64> top_bboxes;
+            for (int i = 0; i < 8; ++ i) {
+                level1_centers[i] = builder.root_cube->center + (child_centers[i] * (cubes_properties[max_depth - 1].edge_length / 2.));
+                level1_bboxes[i]  = child_bbox(builder.root_cube->center, root_bbox, i);
+                for (int j = 0; j < 8; ++ j) {
+                    top_centers[i * 8 + j] = level1_centers[i] + (child_centers[j] * (cubes_properties[max_depth - 2].edge_length / 2.));
+                    top_bboxes[i * 8 + j]  = child_bbox(level1_centers[i], level1_bboxes[i], j);
+                }
+            }
+            // Classify the triangles by the top level cubes they intersect, in parallel.
+            std::vector<uint64_t> triangle_masks(num_triangles, 0);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, num_triangles), [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx)
+                    if (const std::array<Vec3d, 3> tri = triangle(idx); inserted(idx, tri)) {
+                        uint64_t mask = 0;
+                        for (int i = 0; i < 8; ++ i)
+                            if (triangle_AABB_intersects(tri[0], tri[1], tri[2], level1_bboxes[i]))
+                                for (int j = 0; j < 8; ++ j)
+                                    if (triangle_AABB_intersects(tri[0], tri[1], tri[2], top_bboxes[i * 8 + j]))
+                                        mask |= uint64_t(1) << (i * 8 + j);
+                        triangle_masks[idx] = mask;
+                    }
+            });
+            std::array<std::vector<size_t>, 64> top_triangles;
+            for (size_t idx = 0; idx < num_triangles; ++ idx)
+                if (const uint64_t mask = triangle_masks[idx]; mask != 0)
+                    for (int i = 0; i < 64; ++ i)
+                        if (mask & (uint64_t(1) << i))
+                            top_triangles[i].emplace_back(idx);
+            triangle_masks = {};
+            // A triangle intersecting a cube intersects one of its children as well, their bounding boxes cover the cube.
+            // Thus the cubes of the top levels are created for the non-empty lists of triangles.
+            std::array<Cube*, 64> top_cubes {};
+            for (int i = 0; i < 64; ++ i)
+                if (! top_triangles[i].empty()) {
+                    Cube *&level1 = builder.root_cube->children[i / 8];
+                    if (! level1)
+                        level1 = builder.pools.front()->construct(level1_centers[i / 8]);
+                    top_cubes[i] = level1->children[i % 8] = builder.pools.front()->construct(top_centers[i]);
+                }
+            // Build the subtrees below the top levels in parallel.
+            if (max_depth > octree_parallel_levels) {
+                for (int i = 0; i < 64; ++ i)
+                    builder.pools.emplace_back(std::make_unique<OctreeBuilder::Pool>());
+                tbb::parallel_for(tbb::blocked_range<int>(0, 64, 1), [&](const tbb::blocked_range<int> &range) {
+                    for (int i = range.begin(); i < range.end(); ++ i)
+                        for (size_t idx : top_triangles[i]) {
+                            const std::array<Vec3d, 3> tri = triangle(idx);
+                            builder.insert_triangle(tri[0], tri[1], tri[2], top_cubes[i], top_bboxes[i], max_depth - octree_parallel_levels, *builder.pools[i + 1]);
+                        }
+                });
+            }
         }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
-        {
-            // Transform the octree to world coordinates to reduce computation when extracting infill lines.
-            auto rot = transform_to_world().toRotationMatrix();
-            transform_center(octree->root_cube, rot);
-            octree->origin = rot * octree->origin;
+    }
+
+    OctreeBuilder::compact(builder.root_cube, octree->cubes);
+
+    if (cubes_properties.size() > 1) {
+        // Transform the octree to world coordinates to reduce computation when extracting infill lines.
+        auto rot = transform_to_world().toRotationMatrix();
+        for (CompactCube &cube : octree->cubes) {
+#ifndef NDEBUG
+            cube.center_octree = cube.center;
+#endif // NDEBUG
+            cube.center = rot * cube.center;
         }
+        octree->origin = rot * octree->origin;
     }
 
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+void OctreeBuilder::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth, Pool &pool) const
 {
     assert(current_cube);
     assert(depth > 0);
@@ -1526,25 +1653,15 @@ void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cub
     for (size_t i = 0; i < 8; ++ i) {
         const Vec3d &child_center_dir = child_centers[i];
         // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
+        BoundingBoxf3 bbox = child_bbox(current_cube->center, current_bbox, int(i));
         Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
         //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
         // dist2_to_triangle and r2_cube are commented out too.
         if (triangle_AABB_intersects(a, b, c, bbox)) {
             if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
+                current_cube->children[i] = pool.construct(child_center);
             if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
+                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth, pool);
         }
     }
 }
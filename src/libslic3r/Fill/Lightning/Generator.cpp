@@ -10,6 +10,8 @@
 
 #include "ExPolygon.hpp"
 
+#include <tbb/parallel_for.h>
+
 /* Possible future tasks/optimizations,etc.:
  * - Improve connecting heuristic to favor connecting to shorter trees
  * - Change which node of a tree is the root when that would be better in reconnectRoots.
@@ -95,8 +97,20 @@ Generator::Generator(const PrintObject &print_object, const std::function<void()
     m_prune_length                                    = coord_t(layer_thickness * std::tan(lightning_infill_prune_angle));
     m_straightening_max_distance                      = coord_t(layer_thickness * std::tan(lightning_infill_straightening_angle));
 
-    generateInitialInternalOverhangs(print_object, throw_on_cancel_callback);
-    generateTrees(print_object, throw_on_cancel_callback);
+    // The infill areas of all layers, collected in parallel.
+    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layers().size()), [&print_object, &infill_outlines, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_on_cancel_callback();
+            for (const LayerRegion *layerm : print_object.get_layer(int(layer_id))->regions())
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                        append(infill_outlines[layer_id], to_polygons(surface.expolygon));
+        }
+    });
+
+    generateInitialInternalOverhangs(infill_outlines, throw_on_cancel_callback);
+    generateTrees(infill_outlines, throw_on_cancel_callback);
 }
 
 Generator::Generator(PrintObject* m_object, std::vector<Polygons>& contours, std::vector<Polygons>& overhangs, const std::function<void()> &throw_on_cancel_callback, float density)
@@ -137,7 +151,7 @@ Generator::Generator(PrintObject* m_object, std::vector<Polygons>& contours, std
 
     m_overhang_per_layer = overhangs;
 
-    generateTreesforSupport(contours, throw_on_cancel_callback);
+    generateTrees(contours, throw_on_cancel_callback);
 
     //for (size_t i = 0; i < overhangs.size(); i++)
     //{
@@ -147,26 +161,21 @@ Generator::Generator(PrintObject* m_object, std::vector<Polygons>& contours, std
     //}
 }
 
-void Generator::generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+void Generator::generateInitialInternalOverhangs(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback)
 {
-    m_overhang_per_layer.resize(print_object.layers().size());
-
-    Polygons infill_area_above;
-    //Iterate from top to bottom, to subtract the overhang areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
-    for (int layer_nr = int(print_object.layers().size()) - 1; layer_nr >= 0; --layer_nr) {
-        throw_on_cancel_callback();
-        Polygons infill_area_here;
-        for (const LayerRegion* layerm : print_object.get_layer(layer_nr)->regions())
-            for (const Surface& surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_area_here, to_polygons(surface.expolygon));
-
-        //Remove the part of the infill area that is already supported by the walls.
-        Polygons overhang = diff(offset(infill_area_here, -float(m_wall_supporting_radius)), infill_area_above);
-
-        m_overhang_per_layer[layer_nr] = overhang;
-        infill_area_above = std::move(infill_area_here);
-    }
+    m_overhang_per_layer.assign(infill_outlines.size(), Polygons());
+
+    // Subtract the infill area above from the infill area of each layer, to get only overhang in the top layer where it is overhanging.
+    // The layers do not depend on each other, the infill areas of all layers are known.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, infill_outlines.size()), [this, &infill_outlines, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
+            throw_on_cancel_callback();
+            //Remove the part of the infill area that is already supported by the walls.
+            m_overhang_per_layer[layer_nr] = layer_nr + 1 < infill_outlines.size() ?
+                diff(offset(infill_outlines[layer_nr], -float(m_wall_supporting_radius)), infill_outlines[layer_nr + 1]) :
+                diff(offset(infill_outlines[layer_nr], -float(m_wall_supporting_radius)), Polygons());
+        }
+    });
 }
 
 const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
@@ -175,27 +184,38 @@ const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
     return m_lightning_layers[layer_id];
 }
 
-void Generator::generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+// Bounding box of an outline locator created for the preset bounding box bbox and the outlines.
+static BoundingBox outlines_locator_bbox(BoundingBox bbox, const Polygons &outlines)
 {
-    const auto _locator_cell_size = locator_cell_size();
-    m_lightning_layers.resize(print_object.layers().size());
-    bboxs.resize(print_object.layers().size());
-    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
+    for (const Polygon &polygon : outlines)
+        if (polygon.size() > 1)
+            bbox.merge(polygon.points);
+    bbox.min -= Point(EdgeGrid::Grid::bbox_margin, EdgeGrid::Grid::bbox_margin);
+    bbox.max += Point(EdgeGrid::Grid::bbox_margin, EdgeGrid::Grid::bbox_margin);
+    return bbox;
+}
 
-    // For-each layer from top to bottom:
-    for (int layer_id = int(print_object.layers().size()) - 1; layer_id >= 0; layer_id--) {
-        throw_on_cancel_callback();
-        for (const LayerRegion *layerm : print_object.get_layer(layer_id)->regions())
-            for (const Surface &surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_outlines[layer_id], to_polygons(surface.expolygon));
-    }
+void Generator::generateTrees(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback)
+{
+    if (infill_outlines.empty())
+        return;
+
+    m_lightning_layers.resize(infill_outlines.size());
+    bboxs.resize(infill_outlines.size());
 
+    const auto _locator_cell_size = locator_cell_size();
     // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = print_object.layers().size() - 1;
+    const size_t top_layer_id = infill_outlines.size() - 1;
     EdgeGrid::Grid outlines_locator(get_extents(infill_outlines[top_layer_id]).inflated(SCALED_EPSILON));
     outlines_locator.create(infill_outlines[top_layer_id], _locator_cell_size);
 
+    // The outline locators of the next LOCATOR_PREFETCH_LAYERS layers below are created in parallel ahead of the tree walk.
+    // The bounding box of a locator grows with the trees propagated into it, thus a prefetched locator, which was created
+    // for the bounding box expected without such growth, is only used if the walk arrives at the very same bounding box.
+    // prefetched_locators[i] belongs to the layer prefetched_layer_id - i.
+    std::vector<std::pair<BoundingBox, EdgeGrid::Grid>> prefetched_locators;
+    int                                                 prefetched_layer_id = -1;
+
     // For-each layer from top to bottom:
     for (int layer_id = int(top_layer_id); layer_id >= 0; layer_id--) {
         throw_on_cancel_callback();
@@ -206,7 +226,7 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
         bboxs[layer_id] = get_extents(current_outlines);
 
         // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
+        std::vector<NodePtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
 
         current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
         current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
@@ -223,61 +243,42 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
         if (!current_lightning_layer.tree_roots.empty())
             below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
 
-        outlines_locator.set_bbox(below_outlines_bbox);
-        outlines_locator.create(below_outlines, _locator_cell_size);
-
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
-    }
-}
-
-void Generator::generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback)
-{
-    if (contours.empty()) return;
-
-    m_lightning_layers.resize(contours.size());
-    bboxs.resize(contours.size());
-
-    const auto _locator_cell_size = locator_cell_size();
-    // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = contours.size() - 1;
-    EdgeGrid::Grid outlines_locator(get_extents(contours[top_layer_id]).inflated(SCALED_EPSILON));
-    outlines_locator.create(contours[top_layer_id], _locator_cell_size);
-
-    // For-each layer from top to bottom:
-    for (int layer_id = int(top_layer_id); layer_id >= 0; layer_id--) {
-		throw_on_cancel_callback();
-        Layer& current_lightning_layer = m_lightning_layers[layer_id];
-        const Polygons& current_outlines = contours[layer_id];
-        const BoundingBox& current_outlines_bbox = get_extents(current_outlines);
-
-        bboxs[layer_id] = get_extents(current_outlines);
-
-        // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
-
-        current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
-        current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
-
-        // Initialize trees for next lower layer from the current one.
-        if (layer_id == 0)
-            return;
-
-        const Polygons& below_outlines = contours[layer_id - 1];
-        BoundingBox     below_outlines_bbox = get_extents(below_outlines).inflated(SCALED_EPSILON);
-        if (const BoundingBox& outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
-            below_outlines_bbox.merge(outlines_locator_bbox);
-
-        if (!current_lightning_layer.tree_roots.empty())
-            below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
-
-        outlines_locator.set_bbox(below_outlines_bbox);
-        outlines_locator.create(below_outlines, _locator_cell_size);
-
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
+        if (size_t idx = size_t(prefetched_layer_id - (layer_id - 1)); idx >= prefetched_locators.size()) {
+            // Prefetch the locators of the layers below, starting with the exact bounding box of the layer right below.
+            prefetched_layer_id = layer_id - 1;
+            prefetched_locators.assign(std::min<size_t>(LOCATOR_PREFETCH_LAYERS, layer_id), {});
+            BoundingBox bbox = below_outlines_bbox;
+            for (size_t i = 0; i < prefetched_locators.size(); ++ i) {
+                const Polygons &outlines = infill_outlines[prefetched_layer_id - i];
+                if (i > 0) {
+                    BoundingBox locator_bbox = outlines_locator_bbox(prefetched_locators[i - 1].first, infill_outlines[prefetched_layer_id - i + 1]);
+                    bbox = get_extents(outlines).inflated(SCALED_EPSILON);
+                    if (locator_bbox.defined)
+                        bbox.merge(locator_bbox);
+                }
+                prefetched_locators[i].first = bbox;
+            }
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, prefetched_locators.size()), [&prefetched_locators, &infill_outlines, prefetched_layer_id, _locator_cell_size](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    prefetched_locators[i].second.set_bbox(prefetched_locators[i].first);
+                    prefetched_locators[i].second.create(infill_outlines[prefetched_layer_id - i], _locator_cell_size);
+                }
+            });
+        }
+
+        if (size_t idx = size_t(prefetched_layer_id - (layer_id - 1)); prefetched_locators[idx].first == below_outlines_bbox) {
+            outlines_locator = std::move(prefetched_locators[idx].second);
+        } else {
+            // The trees extended the bounding box, the following prefetched locators do not match either.
+            prefetched_locators.clear();
+            outlines_locator.set_bbox(below_outlines_bbox);
+            outlines_locator.create(below_outlines, _locator_cell_size);
+        }
+
+        std::vector<NodePtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
+        NodePool&             lower_nodes = m_lightning_layers[layer_id - 1].nodes;
         for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
+            tree->propagateToNextLayer(lower_trees, lower_nodes, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
     }
 }
 
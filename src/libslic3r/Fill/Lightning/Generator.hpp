@@ -71,14 +71,21 @@ protected:
      * Normally, overhangs are only generated for the outside of the model and
      * only when support is generated. For this pattern, we also need to
      * generate overhang areas for the inside of the model.
+     * \param infill_outlines The infill areas of all layers.
      */
-    void generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+    void generateInitialInternalOverhangs(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback);
 
     /*!
      * Calculate the tree structure of all layers.
+     * \param infill_outlines The areas to be filled of all layers.
      */
-    void generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
-    void generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback);
+    void generateTrees(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback);
+
+    /*!
+     * Number of layers below the current one, whose outline locators are
+     * created in parallel ahead of the tree walk of \ref generateTrees.
+     */
+    static constexpr size_t LOCATOR_PREFETCH_LAYERS = 16;
 
     float m_infill_extrusion_width;
 
@@ -34,7 +34,7 @@ inline static Point to_grid_point(const Point &point, const BoundingBox &bbox)
 
 void Layer::fillLocator(SparseNodeGrid &tree_node_locator, const BoundingBox& current_outlines_bbox)
 {
-    std::function<void(NodeSPtr)> add_node_to_locator_func = [&tree_node_locator, &current_outlines_bbox](const NodeSPtr &node) {
+    std::function<void(NodePtr)> add_node_to_locator_func = [&tree_node_locator, &current_outlines_bbox](const NodePtr &node) {
         tree_node_locator.insert(std::make_pair(to_grid_point(node->getLocation(), current_outlines_bbox), node));
     };
     for (auto& tree : tree_roots)
@@ -67,8 +67,8 @@ void Layer::generateNewTrees
         GroundingLocation grounding_loc = getBestGroundingLocation(
             unsupported_location, current_outlines, current_outlines_bbox, outlines_locator, supporting_radius, wall_supporting_radius, tree_node_locator);
 
-        NodeSPtr new_parent;
-        NodeSPtr new_child;
+        NodePtr new_parent;
+        NodePtr new_child;
         this->attach(unsupported_location, grounding_loc, new_child, new_parent);
         tree_node_locator.insert(std::make_pair(to_grid_point(new_child->getLocation(), current_outlines_bbox), new_child));
         if (new_parent)
@@ -123,7 +123,7 @@ GroundingLocation Layer::getBestGroundingLocation
     const coord_t supporting_radius,
     const coord_t wall_supporting_radius,
     const SparseNodeGrid& tree_node_locator,
-    const NodeSPtr& exclude_tree
+    const NodePtr& exclude_tree
 )
 {
     // Closest point on current_outlines to unsupported_location:
@@ -146,7 +146,7 @@ GroundingLocation Layer::getBestGroundingLocation
 
     const auto within_dist = coord_t((node_location - unsupported_location).cast<double>().norm());
 
-    NodeSPtr sub_tree{nullptr};
+    NodePtr  sub_tree{nullptr};
     coord_t  current_dist = getWeightedDistance(node_location, unsupported_location);
     if (current_dist >= wall_supporting_radius) { // Only reconnect tree roots to other trees if they are not already close to the outlines.
         const coord_t search_radius = std::min(current_dist, within_dist);
@@ -160,11 +160,11 @@ GroundingLocation Layer::getBestGroundingLocation
             for (coord_t grid_addr_y = range.rows().begin(); grid_addr_y < range.rows().end(); ++grid_addr_y)
                 for (coord_t grid_addr_x = range.cols().begin(); grid_addr_x < range.cols().end(); ++grid_addr_x) {
                     const Point local_grid_addr{grid_addr_x, grid_addr_y};
-                    NodeSPtr    local_sub_tree{nullptr};
+                    NodePtr     local_sub_tree{nullptr};
                     coord_t     local_current_dist = current_dist_copy;
                     const auto  it_range           = tree_node_locator.equal_range(local_grid_addr);
                     for (auto it = it_range.first; it != it_range.second; ++it) {
-                        const NodeSPtr candidate_sub_tree = it->second.lock();
+                        const NodePtr candidate_sub_tree = it->second;
                         if ((candidate_sub_tree && candidate_sub_tree != exclude_tree) &&
                             !(exclude_tree && exclude_tree->hasOffspring(candidate_sub_tree)) &&
                             !polygonCollidesWithLineSegment(unsupported_location, candidate_sub_tree->getLocation(), outline_locator)) {
@@ -202,24 +202,24 @@ GroundingLocation Layer::getBestGroundingLocation
 bool Layer::attach(
     const Point& unsupported_location,
     const GroundingLocation& grounding_loc,
-    NodeSPtr& new_child,
-    NodeSPtr& new_root)
+    NodePtr& new_child,
+    NodePtr& new_root)
 {
     // Update trees & distance fields.
     if (grounding_loc.boundary_location) {
-        new_root = Node::create(grounding_loc.p(), std::make_optional(grounding_loc.p()));
-        new_child = new_root->addChild(unsupported_location);
+        new_root = nodes.create(grounding_loc.p(), std::make_optional(grounding_loc.p()));
+        new_child = new_root->addChild(nodes, unsupported_location);
         tree_roots.push_back(new_root);
         return true;
     } else {
-        new_child = grounding_loc.tree_node->addChild(unsupported_location);
+        new_child = grounding_loc.tree_node->addChild(nodes, unsupported_location);
         return false;
     }
 }
 
 void Layer::reconnectRoots
 (
-    std::vector<NodeSPtr>& to_be_reconnected_tree_roots,
+    std::vector<NodePtr>& to_be_reconnected_tree_roots,
     const Polygons& current_outlines,
     const BoundingBox& current_outlines_bbox,
     const EdgeGrid::Grid& outline_locator,
@@ -245,7 +245,7 @@ void Layer::reconnectRoots
                 Point new_root_pt;
                 // Find an intersection of the line segment from root_ptr->getLocation() to ground_loc, at within_max_dist from ground_loc.
                 if (lineSegmentPolygonsIntersection(root_ptr->getLocation(), ground_loc, outline_locator, new_root_pt, within_max_dist)) {
-                    auto new_root = Node::create(new_root_pt, new_root_pt);
+                    NodePtr new_root = nodes.create(new_root_pt, new_root_pt);
                     root_ptr->addChild(new_root);
                     new_root->reroot();
 
@@ -275,7 +275,7 @@ void Layer::reconnectRoots
             if (*ground.boundary_location == root_ptr->getLocation())
                 continue; // Already on the boundary.
 
-            auto new_root = Node::create(ground.p(), ground.p());
+            NodePtr new_root = nodes.create(ground.p(), ground.p());
             auto attach_ptr = root_ptr->closestNode(new_root->getLocation());
             attach_ptr->reroot();
 
@@ -6,8 +6,8 @@
 
 #include "../../EdgeGrid.hpp"
 #include "../../Polygon.hpp"
+#include "TreeNode.hpp"
 
-#include <memory>
 #include <vector>
 #include <list>
 #include <unordered_map>
@@ -16,13 +16,11 @@
 namespace Slic3r::FillLightning
 {
 
-class Node;
-using NodeSPtr = std::shared_ptr<Node>;
-using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
+using SparseNodeGrid = std::unordered_multimap<Point, NodePtr, PointHash>;
 
 struct GroundingLocation
 {
-    NodeSPtr tree_node; //!< not null if the gounding location is on a tree
+    NodePtr tree_node; //!< not null if the gounding location is on a tree
     std::optional<Point> boundary_location; //!< in case the gounding location is on the boundary
     Point p() const;
 };
@@ -35,7 +33,9 @@ struct GroundingLocation
 class Layer
 {
 public:
-    std::vector<NodeSPtr> tree_roots;
+    std::vector<NodePtr> tree_roots;
+    // Owner of the nodes of tree_roots.
+    NodePool             nodes;
 
     void generateNewTrees
     (
@@ -60,7 +60,7 @@ public:
         coord_t supporting_radius,
         coord_t wall_supporting_radius,
         const SparseNodeGrid& tree_node_locator,
-        const NodeSPtr& exclude_tree = nullptr
+        const NodePtr& exclude_tree = nullptr
     );
 
     /*!
@@ -68,11 +68,11 @@ public:
      * \param[out] new_root The new root node if one had been made
      * \return Whether a new root was added
      */
-    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeSPtr& new_child, NodeSPtr& new_root);
+    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodePtr& new_child, NodePtr& new_root);
 
     void reconnectRoots
     (
-        std::vector<NodeSPtr>& to_be_reconnected_tree_roots,
+        std::vector<NodePtr>& to_be_reconnected_tree_roots,
         const Polygons& current_outlines,
         const BoundingBox& current_outlines_bbox,
         const EdgeGrid::Grid& outline_locator,
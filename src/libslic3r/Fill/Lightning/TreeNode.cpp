@@ -19,9 +19,9 @@ coord_t Node::getWeightedDistance(const Point& unsupported_location, const coord
     return dist_here - valence_boost;
 }
 
-bool Node::hasOffspring(const NodeSPtr& to_be_checked) const
+bool Node::hasOffspring(const NodePtr& to_be_checked) const
 {
-    if (to_be_checked == shared_from_this())
+    if (to_be_checked == this)
         return true;
 
     for (auto& child_ptr : m_children)
@@ -31,32 +31,32 @@ bool Node::hasOffspring(const NodeSPtr& to_be_checked) const
     return false;
 }
 
-NodeSPtr Node::addChild(const Point& child_loc)
+NodePtr Node::addChild(NodePool& pool, const Point& child_loc)
 {
     assert(m_p != child_loc);
-    NodeSPtr child = Node::create(child_loc);
-    return addChild(child);
+    return addChild(pool.create(child_loc));
 }
 
-NodeSPtr Node::addChild(NodeSPtr& new_child)
+NodePtr Node::addChild(NodePtr new_child)
 {
-    assert(new_child != shared_from_this());
+    assert(new_child != this);
     //assert(p != new_child->p); // NOTE: No problem for now. Issue to solve later. Maybe even afetr final. Low prio.
     m_children.push_back(new_child);
-    new_child->m_parent = shared_from_this();
+    new_child->m_parent = this;
     new_child->m_is_root = false;
     return new_child;
 }
 
 void Node::propagateToNextLayer(
-    std::vector<NodeSPtr>& next_trees,
+    std::vector<NodePtr>& next_trees,
+    NodePool& next_pool,
     const Polygons& next_outlines,
     const EdgeGrid::Grid& outline_locator,
     const coord_t prune_distance,
     const coord_t smooth_magnitude,
     const coord_t max_remove_colinear_dist) const
 {
-    auto tree_below = deepCopy();
+    NodePtr tree_below = deepCopy(next_pool);
     tree_below->prune(prune_distance);
     tree_below->straighten(smooth_magnitude, max_remove_colinear_dist);
     if (tree_below->realign(next_outlines, outline_locator, next_trees))
@@ -68,18 +68,18 @@ void Node::propagateToNextLayer(
 void Node::visitBranches(const std::function<void(const Point&, const Point&)>& visitor) const
 {
     for (const auto& node : m_children) {
-        assert(node->m_parent.lock() == shared_from_this());
+        assert(node->m_parent == this);
         visitor(m_p, node->m_p);
         node->visitBranches(visitor);
     }
 }
 
 // NOTE: Depth-first, as currently implemented.
-void Node::visitNodes(const std::function<void(NodeSPtr)>& visitor)
+void Node::visitNodes(const std::function<void(NodePtr)>& visitor)
 {
-    visitor(shared_from_this());
+    visitor(this);
     for (const auto& node : m_children) {
-        assert(node->m_parent.lock() == shared_from_this());
+        assert(node->m_parent == this);
         node->visitNodes(visitor);
     }
 }
@@ -88,9 +88,9 @@ Node::Node(const Point& p, const std::optional<Point>& last_grounding_location /
     m_is_root(true), m_p(p), m_last_grounding_location(last_grounding_location)
 {}
 
-NodeSPtr Node::deepCopy() const
+NodePtr Node::deepCopy(NodePool& pool) const
 {
-    NodeSPtr local_root = Node::create(m_p);
+    NodePtr local_root = pool.create(m_p);
     local_root->m_is_root = m_is_root;
     if (m_is_root)
     {
@@ -99,18 +99,18 @@ NodeSPtr Node::deepCopy() const
     local_root->m_children.reserve(m_children.size());
     for (const auto& node : m_children)
     {
-        NodeSPtr child = node->deepCopy();
+        NodePtr child = node->deepCopy(pool);
         child->m_parent = local_root;
         local_root->m_children.push_back(child);
     }
     return local_root;
 }
 
-void Node::reroot(const NodeSPtr &new_parent)
+void Node::reroot(const NodePtr &new_parent)
 {
     if (! m_is_root) {
-        auto old_parent = m_parent.lock();
-        old_parent->reroot(shared_from_this());
+        NodePtr old_parent = m_parent;
+        old_parent->reroot(this);
         m_children.push_back(old_parent);
     }
 
@@ -120,17 +120,17 @@ void Node::reroot(const NodeSPtr &new_parent)
         m_parent = new_parent;
     } else {
         m_is_root = true;
-        m_parent.reset();
+        m_parent = nullptr;
     }
 }
 
-NodeSPtr Node::closestNode(const Point& loc)
+NodePtr Node::closestNode(const Point& loc)
 {
-    NodeSPtr result = shared_from_this();
+    NodePtr result = this;
     auto closest_dist2 = coord_t((m_p - loc).cast<double>().norm());
 
     for (const auto& child : m_children) {
-        NodeSPtr candidate_node = child->closestNode(loc);
+        NodePtr candidate_node = child->closestNode(loc);
         const auto child_dist2 = coord_t((candidate_node->m_p - loc).cast<double>().norm());
         if (child_dist2 < closest_dist2) {
             closest_dist2 = child_dist2;
@@ -187,7 +187,7 @@ bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeG
     return false;
 }
 
-bool Node::realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeSPtr>& rerooted_parts)
+bool Node::realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodePtr>& rerooted_parts)
 {
     if (outlines.empty())
         return false;
@@ -196,12 +196,12 @@ bool Node::realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locat
         // Only keep children that have an unbroken connection to here, realign will put the rest in rerooted parts due to recursion:
         Point coll;
         bool reground_me = false;
-        m_children.erase(std::remove_if(m_children.begin(), m_children.end(), [&](const NodeSPtr &child) {
+        m_children.erase(std::remove_if(m_children.begin(), m_children.end(), [&](const NodePtr &child) {
             bool connect_branch = child->realign(outlines, outline_locator, rerooted_parts);
             // Find an intersection of the line segment from p to child->p, at maximum outline_locator.resolution() * 2 distance from p.
             if (connect_branch && lineSegmentPolygonsIntersection(child->m_p, m_p, outline_locator, coll, outline_locator.resolution() * 2)) {
                 child->m_last_grounding_location.reset();
-                child->m_parent.reset();
+                child->m_parent = nullptr;
                 child->m_is_root = true;
                 rerooted_parts.push_back(child);
                 reground_me = true;
@@ -218,7 +218,7 @@ bool Node::realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locat
     for (auto& child : m_children)
         if (child->realign(outlines, outline_locator, rerooted_parts)) {
             child->m_last_grounding_location = m_p;
-            child->m_parent.reset();
+            child->m_parent = nullptr;
             child->m_is_root = true;
             rerooted_parts.push_back(child);
         }
@@ -263,14 +263,14 @@ Node::RectilinearJunction Node::straighten(
             constexpr coord_t close_enough = 10;
 
             child_p = m_children.front(); //recursive call to straighten might have removed the child
-            const NodeSPtr& parent_node = m_parent.lock();
+            NodePtr parent_node = m_parent;
             if (parent_node &&
                 (child_p->m_p - parent_node->m_p).cast<int64_t>().squaredNorm() < max_remove_colinear_dist2 &&
                 Line::distance_to_squared(m_p, parent_node->m_p, child_p->m_p) < close_enough * close_enough) {
                 child_p->m_parent = m_parent;
                 for (auto& sibling : parent_node->m_children)
                 { // find this node among siblings
-                    if (sibling == shared_from_this())
+                    if (sibling == this)
                     {
                         sibling = child_p; // replace this node by child
                         break;
@@ -413,23 +413,23 @@ void Node::removeJunctionOverlap(Polylines &result_lines, const coord_t line_ove
 }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-void export_to_svg(const NodeSPtr &root_node, SVG &svg)
+void export_to_svg(const NodePtr &root_node, SVG &svg)
 {
-    for (const NodeSPtr &children : root_node->m_children) {
+    for (const NodePtr &children : root_node->m_children) {
         svg.draw(Line(root_node->getLocation(), children->getLocation()), "red");
         export_to_svg(children, svg);
     }
 }
 
-void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes) {
+void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodePtr> &root_nodes) {
     BoundingBox bbox = get_extents(contour);
 
     bbox.offset(SCALED_EPSILON);
     SVG svg(path, bbox);
     svg.draw_outline(contour, "blue");
 
-    for (const NodeSPtr &root_node: root_nodes) {
-        for (const NodeSPtr &children: root_node->m_children) {
+    for (const NodePtr &root_node: root_nodes) {
+        for (const NodePtr &children: root_node->m_children) {
             svg.draw(Line(root_node->getLocation(), children->getLocation()), "red");
             export_to_svg(children, svg);
         }
@@ -4,8 +4,8 @@
 #ifndef LIGHTNING_TREE_NODE_H
 #define LIGHTNING_TREE_NODE_H
 
+#include <deque>
 #include <functional>
-#include <memory>
 #include <optional>
 #include <vector>
 
@@ -21,8 +21,10 @@ namespace Slic3r::FillLightning
 inline coord_t locator_cell_size() { return scaled<coord_t>(4.); }
 
 class Node;
+class NodePool;
 
-using NodeSPtr = std::shared_ptr<Node>;
+// Nodes are owned by a NodePool of their Layer, trees link them by plain pointers without reference counting.
+using NodePtr = Node*;
 
 // NOTE: As written, this struct will only be valid for a single layer, will have to be updated for the next.
 // NOTE: Reasons for implementing this with some separate closures:
@@ -38,19 +40,9 @@ using NodeSPtr = std::shared_ptr<Node>;
  * a tree. The class also has some helper functions specific to Lightning Infill
  * e.g. to straighten the paths around this node.
  */
-class Node : public std::enable_shared_from_this<Node>
+class Node
 {
 public:
-    // Workaround for private/protected constructors and 'make_shared': https://stackoverflow.com/a/27832765
-    template<typename ...Arg> NodeSPtr static create(Arg&&...arg)
-    {
-        struct EnableMakeShared : public Node
-        {
-            explicit EnableMakeShared(Arg&&...arg) : Node(std::forward<Arg>(arg)...) {}
-        };
-        return std::make_shared<EnableMakeShared>(std::forward<Arg>(arg)...);
-    }
-
     /*!
      * Get the position on this layer that this node represents, a vertex of the
      * path to print.
@@ -67,17 +59,18 @@ public:
     /*!
      * Construct a new ``Node`` instance and add it as a child of
      * this node.
+     * \param pool The pool to allocate the new node from.
      * \param p The location of the new node.
-     * \return A shared pointer to the new node.
+     * \return A pointer to the new node.
      */
-    NodeSPtr addChild(const Point& p);
+    NodePtr addChild(NodePool& pool, const Point& p);
 
     /*!
      * Add an existing ``Node`` as a child of this node.
      * \param new_child The node that must be added as a child.
      * \return Always returns \p new_child.
      */
-    NodeSPtr addChild(NodeSPtr& new_child);
+    NodePtr addChild(NodePtr new_child);
 
     /*!
      * Propagate this node's sub-tree to the next layer.
@@ -87,6 +80,7 @@ public:
      * this node and all of its descendant nodes will be added to the
      * \p next_trees vector.
      * \param next_trees A collection of tree nodes to use for the next layer.
+     * \param next_pool The pool of the next layer to allocate the copy from.
      * \param next_outlines The shape of the layer below, to make sure that the
      * tree stays within the bounds of the infill area.
      * \param prune_distance The maximum distance that a leaf node may be moved
@@ -99,7 +93,8 @@ public:
      */
     void propagateToNextLayer
     (
-        std::vector<NodeSPtr>& next_trees,
+        std::vector<NodePtr>& next_trees,
+        NodePool& next_pool,
         const Polygons& next_outlines,
         const EdgeGrid::Grid& outline_locator,
         coord_t prune_distance,
@@ -130,7 +125,7 @@ public:
      * \param visitor A function to execute for every node in this node's sub-
      * tree.
      */
-    void visitNodes(const std::function<void(NodeSPtr)>& visitor);
+    void visitNodes(const std::function<void(NodePtr)>& visitor);
 
     /*!
      * Get a weighted distance from an unsupported point to this node (given the current supporting radius).
@@ -159,14 +154,14 @@ public:
      * This is then recursively bubbled up until it reaches the (former) root, which then will become a leaf.
      * \param new_parent The (new) parent-node of the root, useful for recursing or immediately attaching the node to another tree.
      */
-    void reroot(const NodeSPtr &new_parent = nullptr);
+    void reroot(const NodePtr &new_parent = nullptr);
 
     /*!
      * Retrieves the closest node to the specified location.
      * \param loc The specified location.
      * \result The branch that starts at the position closest to the location within this tree.
      */
-    NodeSPtr closestNode(const Point& loc);
+    NodePtr closestNode(const Point& loc);
 
     /*!
      * Returns whether the given tree node is a descendant of this node.
@@ -177,7 +172,7 @@ public:
      * \return ``true`` if the given node is a descendant or this node itself,
      * or ``false`` if it is not in the sub-tree.
      */
-    bool hasOffspring(const NodeSPtr& to_be_checked) const;
+    bool hasOffspring(const NodePtr& to_be_checked) const;
 
     Node() = delete; // Don't allow empty contruction
 
@@ -192,15 +187,16 @@ protected:
 
     /*!
      * Copy this node and its entire sub-tree.
+     * \param pool The pool to allocate the copy from.
      * \return The equivalent of this node in the copy (the root of the new sub-
      * tree).
      */
-    NodeSPtr deepCopy() const;
+    NodePtr deepCopy(NodePool& pool) const;
 
     /*! Reconnect trees from the layer above to the new outlines of the lower layer.
      * \return Wether or not the root is kept (false is no, true is yes).
      */
-    bool realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeSPtr>& rerooted_parts);
+    bool realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodePtr>& rerooted_parts);
 
     struct RectilinearJunction
     {
@@ -266,43 +262,77 @@ protected:
 
     bool m_is_root;
     Point m_p;
-    std::weak_ptr<Node> m_parent;
-    std::vector<NodeSPtr> m_children;
+    NodePtr m_parent { nullptr };
+    std::vector<NodePtr> m_children;
 
     std::optional<Point> m_last_grounding_location;  //<! The last known grounding location, see 'getLastGroundingLocation()'.
 
-    friend BoundingBox get_extents(const NodeSPtr &root_node);
-    friend BoundingBox get_extents(const std::vector<NodeSPtr> &tree_roots);
+    friend BoundingBox get_extents(const NodePtr &root_node);
+    friend BoundingBox get_extents(const std::vector<NodePtr> &tree_roots);
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-    friend void export_to_svg(const NodeSPtr &root_node, Slic3r::SVG &svg);
-    friend void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes);
+    friend void export_to_svg(const NodePtr &root_node, Slic3r::SVG &svg);
+    friend void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodePtr> &root_nodes);
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 };
 
+/*!
+ * Owner of the nodes of the trees of a single layer.
+ *
+ * The nodes are allocated in chunks and keep their address for the lifetime of
+ * the pool. Nodes cut off a tree (pruned, straightened or realigned away) stay
+ * in the pool until it is destroyed together with its layer.
+ */
+class NodePool
+{
+public:
+    NodePool() = default;
+    NodePool(NodePool&&) = default;
+    NodePool& operator=(NodePool&&) = default;
+    // The trees point into the pool, a copy of the pool would not be referenced by anything.
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    template<typename ...Arg> NodePtr create(Arg&&...arg)
+    {
+        return &m_nodes.emplace_back(std::forward<Arg>(arg)...);
+    }
+
+    size_t size() const { return m_nodes.size(); }
+
+private:
+    // Gives the pool access to the protected constructor of Node.
+    struct PooledNode : public Node
+    {
+        template<typename ...Arg> explicit PooledNode(Arg&&...arg) : Node(std::forward<Arg>(arg)...) {}
+    };
+
+    std::deque<PooledNode> m_nodes;
+};
+
 bool inside(const Polygons &polygons, const Point &p);
 bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeGrid::Grid& outline_locator, Point& result, coord_t within_max_dist);
 
-inline BoundingBox get_extents(const NodeSPtr &root_node)
+inline BoundingBox get_extents(const NodePtr &root_node)
 {
     BoundingBox bbox;
-    for (const NodeSPtr &children : root_node->m_children)
+    for (const NodePtr &children : root_node->m_children)
         bbox.merge(get_extents(children));
     bbox.merge(root_node->getLocation());
     return bbox;
 }
 
-inline BoundingBox get_extents(const std::vector<NodeSPtr> &tree_roots)
+inline BoundingBox get_extents(const std::vector<NodePtr> &tree_roots)
 {
     BoundingBox bbox;
-    for (const NodeSPtr &root_node : tree_roots)
+    for (const NodePtr &root_node : tree_roots)
         bbox.merge(get_extents(root_node));
     return bbox;
 }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-void export_to_svg(const NodeSPtr &root_node, SVG &svg);
-void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes);
+void export_to_svg(const NodePtr &root_node, SVG &svg);
+void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodePtr> &root_nodes);
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 
 } // namespace Slic3r::FillLightning
@@ -480,8 +480,13 @@ sla::RasterEncoder SL1Archive::get_encoder() const
 
 void SL1Archive::export_print(Zipper& zipper,
                               const SLAPrint &print,
-                              const std::string &prjname)
+                              const std::string &prjname,
+                              std::function<void()> throw_if_canceled,
+                              std::function<void(int)> statusfn)
 {
+    if (throw_if_canceled == nullptr) throw_if_canceled = []() {};
+    if (statusfn == nullptr) statusfn = [](int) {};
+
     std::string project =
         prjname.empty() ?
             boost::filesystem::path(zipper.get_filename()).stem().string() :
@@ -500,14 +505,38 @@ void SL1Archive::export_print(Zipper& zipper,
         zipper.add_entry("prusaslicer.ini");
         zipper << to_ini(slicerconf);
         
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        auto add_layer = [&zipper, &project](const sla::EncodedRaster &rst, size_t idx) {
+            std::string imgname = project + string_printf("%.5d", int(idx)) + "." +
                                   rst.extension();
             
             zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+        };
+
+        if (m_layers.empty()) {
+            const std::vector<SLAPrint::PrintLayer> &layers = print.print_layers();
+            int last_status = -1;
+            stream_layers(layers.size(),
+                [&layers, &throw_if_canceled](sla::RasterBase &raster, size_t idx) {
+                    throw_if_canceled();
+                    for (const ExPolygon &poly : layers[idx].transformed_slices())
+                        raster.draw(poly);
+                },
+                // Called serially in the order of the layers.
+                [&add_layer, &statusfn, &last_status, &layers](const sla::EncodedRaster &rst, size_t idx) {
+                    add_layer(rst, idx);
+                    int status = int(100 * (idx + 1) / layers.size());
+                    if (status > last_status) {
+                        statusfn(status);
+                        last_status = status;
+                    }
+                },
+                [&throw_if_canceled]() { throw_if_canceled(); return false; });
+        } else {
+            for (size_t i = 0; i < m_layers.size(); ++i)
+                add_layer(m_layers[i], i);
         }
+    } catch(CanceledException&) {
+        throw;
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
         // Rethrow the exception
@@ -21,11 +21,18 @@ public:
     explicit SL1Archive(const SLAPrinterConfig &cfg): m_cfg(cfg) {}
     explicit SL1Archive(SLAPrinterConfig &&cfg): m_cfg(std::move(cfg)) {}
     
-    void export_print(Zipper &zipper, const SLAPrint &print, const std::string &projectname = "");
-    void export_print(const std::string &fname, const SLAPrint &print, const std::string &projectname = "")
+    // The layers are rasterized in parallel while the archive is written,
+    // see SLAArchive::stream_layers().
+    bool streams_layers() const override { return true; }
+
+    // throw_if_canceled and statusfn (0 - 100) are called while the layers are being rasterized.
+    void export_print(Zipper &zipper, const SLAPrint &print, const std::string &projectname = "",
+                      std::function<void()> throw_if_canceled = nullptr, std::function<void(int)> statusfn = nullptr);
+    void export_print(const std::string &fname, const SLAPrint &print, const std::string &projectname = "",
+                      std::function<void()> throw_if_canceled = nullptr, std::function<void(int)> statusfn = nullptr)
     {
         Zipper zipper(fname);
-        export_print(zipper, print, projectname);
+        export_print(zipper, print, projectname, std::move(throw_if_canceled), std::move(statusfn));
     }
     
     void apply(const SLAPrinterConfig &cfg) override
@@ -36,6 +36,7 @@
 #include <string>
 #include <utility>
 #include <string_view>
+#include <deque>
 
 #include <regex>
 #include <boost/algorithm/string.hpp>
@@ -108,6 +109,8 @@ static const float g_purge_volume_one_time = 135.f;
 static const int g_max_flush_count = 5;
 // static const size_t g_max_label_object = 64;
 static const double smooth_speed_step = 10;
+// Number of layers, for which AvoidCrossingPerimeters prepares its layer data in parallel ahead of the G-code generator.
+static const size_t AVOID_CROSSING_PERIMETERS_PREFETCH_LAYERS = 16;
 
 Vec2d travel_point_1;
 Vec2d travel_point_2;
@@ -4535,12 +4538,16 @@ void GCode::process_layers(
     for (const PrintInstance* instance : print_object_instances_ordering)
         object_label.push_back(instance->model_instance->get_labeled_id());
 
-    std::vector<LayerResult> layers_results;
-    layers_results.resize(layers_to_print.size());
+    // Index of the layer, at which the generator pauses the pipeline, see the outer wall speed smoothing below.
+    size_t generator_pause_idx = size_t(-1);
 
     // The pipeline is variable: The vase mode filter is optional.
     const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> LayerResult {
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx, &generator_pause_idx](tbb::flow_control& fc) -> LayerResult {
+            if (layer_to_print_idx == generator_pause_idx) {
+                fc.stop();
+                return {};
+            }
             if (layer_to_print_idx >= layers_to_print.size()) {
                 if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
                     fc.stop();
@@ -4552,6 +4559,15 @@ void GCode::process_layers(
                     return LayerResult::make_nop_layer_result();
                 }
             } else {
+                if (m_config.reduce_crossing_wall && layer_to_print_idx % AVOID_CROSSING_PERIMETERS_PREFETCH_LAYERS == 0) {
+                    // Prepare the layer data of AvoidCrossingPerimeters for the next batch of layers in parallel.
+                    std::vector<const Layer*> prefetch;
+                    for (size_t i = layer_to_print_idx; i < std::min(layers_to_print.size(), layer_to_print_idx + AVOID_CROSSING_PERIMETERS_PREFETCH_LAYERS); ++ i)
+                        for (const LayerToPrint &layer_to_print : layers_to_print[i].second)
+                            if (const Layer *layer = layer_to_print.layer(); layer)
+                                prefetch.emplace_back(layer);
+                    m_avoid_crossing_perimeters.prefetch_layers(prefetch);
+                }
                 const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
                 print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
@@ -4607,12 +4623,17 @@ void GCode::process_layers(
 
     // step 4.1: record node data
     SmoothCalculator smooth_calculator(object_label.size());
+    // Layers waiting for their outer wall speed to be smoothed, in the order of the smooth_calculator layers.
+    std::deque<LayerResult> smoothing_layers;
 
     const auto build_node = tbb::make_filter<LayerResult, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&smooth_calculator, &layers_wall_collection, &layers_extruder_adjustments, object_label, &layers_results](LayerResult in) {
+        [&smooth_calculator, &layers_wall_collection, &layers_extruder_adjustments, object_label, &smoothing_layers](LayerResult in) {
             smooth_calculator.build_node(layers_wall_collection[in.gcode_store_pos], object_label, layers_extruder_adjustments[in.gcode_store_pos]);
-            layers_results[in.gcode_store_pos] = std::move(in);
-            return;
+            // remove empty gcode layer caused by support independent layers
+            if (in.cooling_buffer_flush) {
+                smooth_calculator.append_data(std::move(layers_wall_collection[in.gcode_store_pos]));
+                smoothing_layers.emplace_back(std::move(in));
+            }
         });
 
     // step 5: rewrite
@@ -4621,22 +4642,26 @@ void GCode::process_layers(
             return gcode_editor.write_layer_gcode(std::move(in.gcode), in.layer_id, in.layer_time, layers_extruder_adjustments[in.gcode_store_pos]);
         });
 
-    std::vector<LayerResult> gcode_res;
-
     // BBS: apply new feedrate of outwall and recalculate layer time
+    // Index of the first layer of smoothing_layers in smooth_calculator, number of smoothing_layers to be written.
     int        layer_idx            = 0;
+    size_t     layers_to_write      = 0;
+    std::vector<size_t> written_layers;
     const auto calculate_layer_time = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&layer_idx, &smooth_calculator, &layers_extruder_adjustments, &gcode_res](tbb::flow_control& fc) -> LayerResult {
-            if (layer_idx == gcode_res.size()) {
+        [&layer_idx, &layers_to_write, &written_layers, &smoothing_layers, &smooth_calculator, &layers_extruder_adjustments](tbb::flow_control& fc) -> LayerResult {
+            if (layers_to_write == 0) {
                 fc.stop();
                 return {};
             } else {
+                -- layers_to_write;
+                LayerResult res = std::move(smoothing_layers.front());
+                smoothing_layers.pop_front();
                 if (layer_idx > 0) {
-                    gcode_res[layer_idx].layer_time =
-                        smooth_calculator.recaculate_layer_time(layer_idx,
-                                                                layers_extruder_adjustments[gcode_res[layer_idx].gcode_store_pos]);
+                    res.layer_time = smooth_calculator.recaculate_layer_time(layer_idx, layers_extruder_adjustments[res.gcode_store_pos]);
                 }
-                return gcode_res[layer_idx++];
+                ++ layer_idx;
+                written_layers.emplace_back(res.gcode_store_pos);
+                return res;
             }
         });
 
@@ -4777,23 +4802,30 @@ void GCode::process_layers(
         else
             tbb::parallel_pipeline(12, generator & parsing & cooling & write_gcode & fan_mover & output);
     } else {
-        if (m_pressure_equalizer)
-            tbb::parallel_pipeline(12, generator & pressure_equalizer & parsing & cooling & build_node);
-        else
-            tbb::parallel_pipeline(12, generator & parsing & cooling & build_node);
+        // step 4.2: smoothing
+        // The pipeline is broken into windows of layers. The outer wall speed of a layer is final and the layer is written
+        // once smoothing_lookahead_layers layers above it were generated, thus only the G-code of a bounded number of layers
+        // is held in memory.
+        for (bool finished = false; ! finished;) {
+            finished            = layers_to_print.size() - layer_to_print_idx <= size_t(smoothing_lookahead_layers);
+            generator_pause_idx = finished ? size_t(-1) : layer_to_print_idx + smoothing_lookahead_layers;
+            if (m_pressure_equalizer)
+                tbb::parallel_pipeline(12, generator & pressure_equalizer & parsing & cooling & build_node);
+            else
+                tbb::parallel_pipeline(12, generator & parsing & cooling & build_node);
 
-        // append data
-        for (const LayerResult& res : layers_results) {
-            // remove empty gcode layer caused by support independent layers
-            if (res.cooling_buffer_flush) {
-                smooth_calculator.append_data(layers_wall_collection[res.gcode_store_pos]);
-                gcode_res.push_back(std::move(res));
-            }
-        }
+            smooth_calculator.smooth_layer_speed(layer_idx);
 
-        smooth_calculator.smooth_layer_speed();
+            layers_to_write = finished ? smoothing_layers.size() :
+                                         size_t(std::max(0, smooth_calculator.layers_count() - smoothing_lookahead_layers - layer_idx));
+            tbb::parallel_pipeline(12, calculate_layer_time & write_gcode & fan_mover & output);
 
-        tbb::parallel_pipeline(12, calculate_layer_time & write_gcode & fan_mover & output);
+            // The written layers are final, release their data.
+            for (size_t gcode_store_pos : written_layers)
+                std::vector<PerExtruderAdjustments>().swap(layers_extruder_adjustments[gcode_store_pos]);
+            written_layers.clear();
+            smooth_calculator.release_layers(layer_idx);
+        }
     }
 }
 
@@ -4821,13 +4853,17 @@ void GCode::process_layers(
     for (LayerToPrint layer : layers_to_print)
         object_label.push_back(layer.original_object->instances()[single_object_idx].model_instance->get_labeled_id());
 
-    std::vector<LayerResult> layers_results;
-    layers_results.resize(layers_to_print.size());
+    // Index of the layer, at which the generator pauses the pipeline, see the outer wall speed smoothing below.
+    size_t generator_pause_idx = size_t(-1);
 
     // step 1: generator
     // The pipeline is variable: The vase mode filter is optional.
     const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
+        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, &generator_pause_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
+            if (layer_to_print_idx == generator_pause_idx) {
+                fc.stop();
+                return {};
+            }
             if (layer_to_print_idx >= layers_to_print.size()) {
                 if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
                     fc.stop();
@@ -4839,6 +4875,14 @@ void GCode::process_layers(
                     return LayerResult::make_nop_layer_result();
                 }
             } else {
+                if (m_config.reduce_crossing_wall && layer_to_print_idx % AVOID_CROSSING_PERIMETERS_PREFETCH_LAYERS == 0) {
+                    // Prepare the layer data of AvoidCrossingPerimeters for the next batch of layers in parallel.
+                    std::vector<const Layer*> prefetch;
+                    for (size_t i = layer_to_print_idx; i < std::min(layers_to_print.size(), layer_to_print_idx + AVOID_CROSSING_PERIMETERS_PREFETCH_LAYERS); ++ i)
+                        if (const Layer *layer = layers_to_print[i].layer(); layer)
+                            prefetch.emplace_back(layer);
+                    m_avoid_crossing_perimeters.prefetch_layers(prefetch);
+                }
                 LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
                 print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
                 //BBS
@@ -4894,12 +4938,17 @@ void GCode::process_layers(
 
     // step 4.1: record node data
     SmoothCalculator smooth_calculator(object_label.size());
+    // Layers waiting for their outer wall speed to be smoothed, in the order of the smooth_calculator layers.
+    std::deque<LayerResult> smoothing_layers;
 
     const auto build_node = tbb::make_filter<LayerResult, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&smooth_calculator, &layers_wall_collection, &layers_extruder_adjustments, object_label, &layers_results](LayerResult in) {
+        [&smooth_calculator, &layers_wall_collection, &layers_extruder_adjustments, object_label, &smoothing_layers](LayerResult in) {
             smooth_calculator.build_node(layers_wall_collection[in.gcode_store_pos], object_label, layers_extruder_adjustments[in.gcode_store_pos]);
-            layers_results[in.gcode_store_pos] = std::move(in);
-            return;
+            // remove empty gcode layer caused by support independent layers
+            if (in.cooling_buffer_flush) {
+                smooth_calculator.append_data(std::move(layers_wall_collection[in.gcode_store_pos]));
+                smoothing_layers.emplace_back(std::move(in));
+            }
         });
 
     // step 5: rewrite
@@ -4908,23 +4957,26 @@ void GCode::process_layers(
             return gcode_editor.write_layer_gcode(std::move(in.gcode), in.layer_id, in.layer_time, layers_extruder_adjustments[in.gcode_store_pos]);
         });
 
-    std::vector<LayerResult> gcode_res;
-
     // BBS: apply new feedrate of outwall and recalculate layer time
+    // Index of the first layer of smoothing_layers in smooth_calculator, number of smoothing_layers to be written.
     int        layer_idx            = 0;
-    // restart pipeline
+    size_t     layers_to_write      = 0;
+    std::vector<size_t> written_layers;
     const auto calculate_layer_time = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&layer_idx, &gcode_res, &smooth_calculator, &layers_extruder_adjustments](tbb::flow_control& fc) -> LayerResult {
-            if (layer_idx == gcode_res.size()) {
+        [&layer_idx, &layers_to_write, &written_layers, &smoothing_layers, &smooth_calculator, &layers_extruder_adjustments](tbb::flow_control& fc) -> LayerResult {
+            if (layers_to_write == 0) {
                 fc.stop();
                 return {};
             } else {
+                -- layers_to_write;
+                LayerResult res = std::move(smoothing_layers.front());
+                smoothing_layers.pop_front();
                 if (layer_idx > 0) {
-                    gcode_res[layer_idx].layer_time =
-                        smooth_calculator.recaculate_layer_time(layer_idx,
-                                                                layers_extruder_adjustments[gcode_res[layer_idx].gcode_store_pos]);
+                    res.layer_time = smooth_calculator.recaculate_layer_time(layer_idx, layers_extruder_adjustments[res.gcode_store_pos]);
                 }
-                return gcode_res[layer_idx++];
+                ++ layer_idx;
+                written_layers.emplace_back(res.gcode_store_pos);
+                return res;
             }
         });
 
@@ -4997,24 +5049,30 @@ void GCode::process_layers(
         else
             tbb::parallel_pipeline(12, generator & parsing & cooling & write_gcode & fan_mover & output);
     } else {
-        if (m_pressure_equalizer)
-            tbb::parallel_pipeline(12, generator & pressure_equalizer & parsing & cooling & build_node);
-        else
-            tbb::parallel_pipeline(12, generator & parsing & cooling & build_node);
         // step 4.2: smoothing
-        // break pipeline and do z smoothing
-        // append data
-        for (const LayerResult& res : layers_results) {
-            // remove empty gcode layer caused by support independent layers
-            if (res.cooling_buffer_flush) {
-                smooth_calculator.append_data(layers_wall_collection[res.gcode_store_pos]);
-                gcode_res.push_back(res);
-            }
-        }
+        // The pipeline is broken into windows of layers. The outer wall speed of a layer is final and the layer is written
+        // once smoothing_lookahead_layers layers above it were generated, thus only the G-code of a bounded number of layers
+        // is held in memory.
+        for (bool finished = false; ! finished;) {
+            finished            = layers_to_print.size() - layer_to_print_idx <= size_t(smoothing_lookahead_layers);
+            generator_pause_idx = finished ? size_t(-1) : layer_to_print_idx + smoothing_lookahead_layers;
+            if (m_pressure_equalizer)
+                tbb::parallel_pipeline(12, generator & pressure_equalizer & parsing & cooling & build_node);
+            else
+                tbb::parallel_pipeline(12, generator & parsing & cooling & build_node);
 
-        smooth_calculator.smooth_layer_speed();
+            smooth_calculator.smooth_layer_speed(layer_idx);
 
-        tbb::parallel_pipeline(12, calculate_layer_time & write_gcode & fan_mover & output);
+            layers_to_write = finished ? smoothing_layers.size() :
+                                         size_t(std::max(0, smooth_calculator.layers_count() - smoothing_lookahead_layers - layer_idx));
+            tbb::parallel_pipeline(12, calculate_layer_time & write_gcode & fan_mover & output);
+
+            // The written layers are final, release their data.
+            for (size_t gcode_store_pos : written_layers)
+                std::vector<PerExtruderAdjustments>().swap(layers_extruder_adjustments[gcode_store_pos]);
+            written_layers.clear();
+            smooth_calculator.release_layers(layer_idx);
+        }
     }
 }
 
@@ -9,10 +9,13 @@
 #include "../SVG.hpp"
 #include "AvoidCrossingPerimeters.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <tbb/parallel_for.h>
+
 //#define AVOID_CROSSING_PERIMETERS_DEBUG_OUTPUT
 
 namespace Slic3r {
@@ -1183,7 +1186,7 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d endf   = end  .cast<double>();
 
     bool is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)))) {
+    if (!use_external && (is_support_layer || (!m_lslices_offset->lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset->lslices_offset, m_lslices_offset->lslices_offset_bboxes, m_lslices_offset->grid_lslices_offset, travel)))) {
         // Initialize m_internal only when it is necessary.
         if (m_internal.boundaries.empty())
             init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
@@ -1233,32 +1236,58 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset->lslices_offset, m_lslices_offset->lslices_offset_bboxes, m_lslices_offset->grid_lslices_offset, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static std::shared_ptr<const AvoidCrossingPerimeters::LslicesOffset> make_lslices_offset(const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
+    auto out = std::make_shared<AvoidCrossingPerimeters::LslicesOffset>();
 
     float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices, perimeter_offset);
+    out->lslices_offset    = offset_ex(layer.lslices, perimeter_offset);
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+    out->lslices_offset_bboxes.reserve(out->lslices_offset.size());
+    for (const ExPolygon &ex_poly : out->lslices_offset)
+        out->lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    out->grid_lslices_offset.set_bbox(bbox_slice);
+    out->grid_lslices_offset.create(out->lslices_offset, coord_t(scale_(1.)));
+    return out;
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    m_internal.clear();
+    m_external.clear();
+
+    auto it = std::find_if(m_prefetched_lslices_offsets.begin(), m_prefetched_lslices_offsets.end(),
+                           [&layer](const auto &prefetched) { return prefetched.first == &layer; });
+    m_lslices_offset = it == m_prefetched_lslices_offsets.end() ? make_lslices_offset(layer) : it->second;
+}
+
+void AvoidCrossingPerimeters::prefetch_layers(const std::vector<const Layer*> &layers)
+{
+    std::vector<std::pair<const Layer*, std::shared_ptr<const LslicesOffset>>> prefetched;
+    prefetched.reserve(layers.size());
+    for (const Layer *layer : layers) {
+        auto it = std::find_if(m_prefetched_lslices_offsets.begin(), m_prefetched_lslices_offsets.end(),
+                               [layer](const auto &prefetched) { return prefetched.first == layer; });
+        prefetched.emplace_back(layer, it == m_prefetched_lslices_offsets.end() ? nullptr : std::move(it->second));
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, prefetched.size()), [&prefetched](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            if (! prefetched[i].second)
+                prefetched[i].second = make_lslices_offset(*prefetched[i].first);
+    });
+    m_prefetched_lslices_offsets = std::move(prefetched);
 }
 
 #if 0
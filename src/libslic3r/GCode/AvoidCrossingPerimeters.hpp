@@ -5,6 +5,8 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -24,6 +26,9 @@ public:
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
     void        init_layer(const Layer &layer);
+    // Precompute the layer dependent data of init_layer() for the layers to be printed next in parallel.
+    // Data prefetched for layers not in the list is released.
+    void        prefetch_layers(const std::vector<const Layer*> &layers);
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -50,6 +55,15 @@ public:
         }
     };
 
+    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+    // Depends on the layer only, not on the state of the G-code generator.
+    struct LslicesOffset {
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+    };
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -58,11 +72,10 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
+    // Lslices offset of the current layer, set by init_layer().
+    std::shared_ptr<const LslicesOffset>                                       m_lslices_offset { std::make_shared<LslicesOffset>() };
+    // Lslices offsets precomputed by prefetch_layers().
+    std::vector<std::pair<const Layer*, std::shared_ptr<const LslicesOffset>>> m_prefetched_lslices_offsets;
     // Store all needed data for travels inside object
     Boundary m_internal;
     // Store all needed data for travels outside object
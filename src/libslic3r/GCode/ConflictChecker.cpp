@@ -1,9 +1,8 @@
 #include "ConflictChecker.hpp"
 
 #include <tbb/parallel_for.h>
-#include <tbb/concurrent_vector.h>
 
-#include <map>
+#include <algorithm>
 #include <functional>
 #include <atomic>
 
@@ -11,7 +10,6 @@ namespace Slic3r {
 
 namespace RasterizationImpl {
 using IndexPair = std::pair<int64_t, int64_t>;
-using Grids     = std::vector<IndexPair>;
 
 inline IndexPair point_map_grid_index(const Point &pt, int64_t xdist, int64_t ydist)
 {
@@ -22,9 +20,11 @@ inline IndexPair point_map_grid_index(const Point &pt, int64_t xdist, int64_t yd
 
 inline bool nearly_equal(const Point &p1, const Point &p2) { return std::abs(p1.x() - p2.x()) < SCALED_EPSILON && std::abs(p1.y() - p2.y()) < SCALED_EPSILON; }
 
-inline Grids line_rasterization(const Line &line, int64_t xdist = scale_(1), int64_t ydist = scale_(1))
+// Visit all grid cells crossed by the line.
+template<typename VisitCell>
+inline void line_rasterization(const Line &line, VisitCell &&visit, int64_t xdist = scale_(1), int64_t ydist = scale_(1))
 {
-    Grids     res;
+    size_t    cnt          = 0;
     Point     rayStart     = line.a;
     Point     rayEnd       = line.b;
     IndexPair currentVoxel = point_map_grid_index(rayStart, xdist, ydist);
@@ -48,7 +48,7 @@ inline Grids line_rasterization(const Line &line, int64_t xdist = scale_(1), int
     double tDeltaX = ray.x() != 0 ? static_cast<double>(xdist) / ray.x() * stepX : DBL_MAX;
     double tDeltaY = ray.y() != 0 ? static_cast<double>(ydist) / ray.y() * stepY : DBL_MAX;
 
-    res.push_back(currentVoxel);
+    visit(currentVoxel);
 
     double tx = tMaxX;
     double ty = tMaxY;
@@ -57,14 +57,14 @@ inline Grids line_rasterization(const Line &line, int64_t xdist = scale_(1), int
         if (lastVoxel.first == currentVoxel.first) {
             for (int64_t i = currentVoxel.second; i != lastVoxel.second; i += (int64_t) stepY) {
                 currentVoxel.second += (int64_t) stepY;
-                res.push_back(currentVoxel);
+                visit(currentVoxel);
             }
             break;
         }
         if (lastVoxel.second == currentVoxel.second) {
             for (int64_t i = currentVoxel.first; i != lastVoxel.first; i += (int64_t) stepX) {
                 currentVoxel.first += (int64_t) stepX;
-                res.push_back(currentVoxel);
+                visit(currentVoxel);
             }
             break;
         }
@@ -76,20 +76,74 @@ inline Grids line_rasterization(const Line &line, int64_t xdist = scale_(1), int
             currentVoxel.second += (int64_t) stepY;
             ty += tDeltaY;
         }
-        res.push_back(currentVoxel);
-        if (res.size() >= 100000) { // bug
+        visit(currentVoxel);
+        if (++ cnt >= 100000) { // bug
             assert(0);
         }
     }
-
-    return res;
 }
 } // namespace RasterizationImpl
 
+void LinesBucket::update_bounding_boxes()
+{
+    _pileBBoxes.assign(_piles.size(), BoundingBox());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, _piles.size()), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            BoundingBox &bbox = _pileBBoxes[i];
+            for (const ExtrusionPath &path : _piles[i].paths)
+                if (path.is_force_no_extrusion() == false)
+                    // Merge point by point, BoundingBox(Points) is left undefined for axis aligned lines.
+                    for (const Point &pt : path.polyline.points)
+                        bbox.merge(pt);
+            if (bbox.defined)
+                bbox.translate(_offset.x(), _offset.y());
+        }
+    });
+}
+
+BoundingBox LinesBucket::bounding_box() const
+{
+    return this->bounding_box(0, int(_piles.size()));
+}
+
+BoundingBox LinesBucket::bounding_box(int begin, int end) const
+{
+    assert(_pileBBoxes.size() == _piles.size());
+    BoundingBox bbox;
+    for (int i = begin; i < end; ++ i)
+        if (_pileBBoxes[i].defined)
+            bbox.merge(_pileBBoxes[i]);
+    return bbox;
+}
+
+void LinesBucket::lines(int begin, int end, const BoundingBoxes &filter, LineWithIDs &out) const
+{
+    for (int i = begin; i < end; ++ i) {
+        for (const ExtrusionPath &path : _piles[i].paths) {
+            if (path.is_force_no_extrusion() || path.polyline.points.size() < 2)
+                continue;
+            Point prev = path.polyline.points.front() + _offset;
+            for (auto it = path.polyline.points.begin() + 1; it != path.polyline.points.end(); ++ it) {
+                Point       next = *it + _offset;
+                BoundingBox line_bbox(prev.cwiseMin(next), prev.cwiseMax(next));
+                line_bbox.defined = true;
+                if (std::any_of(filter.begin(), filter.end(), [&line_bbox](const BoundingBox &bbox) { return bbox.overlap(line_bbox); }))
+                    out.emplace_back(Line(prev, next), _id, path.role());
+                prev = next;
+            }
+        }
+    }
+}
+
 void LinesBucketQueue::emplace_back_bucket(ExtrusionLayers &&els, const void *objPtr, Point offset)
+{
+    this->emplace_back_bucket(LinesBucket(std::move(els), objPtr, offset));
+}
+
+void LinesBucketQueue::emplace_back_bucket(LinesBucket &&bucket)
 {
     auto oldSize = line_buckets.capacity();
-    line_buckets.emplace_back(std::move(els), objPtr, offset);
+    line_buckets.emplace_back(std::move(bucket));
     auto newSize = line_buckets.capacity();
     // Since line_bucket_ptr_queue is storing pointers into line_buckets,
     // we need to handle the case where the capacity changes since that makes
@@ -125,16 +179,16 @@ float LinesBucketQueue::getCurrBottomZ()
     return layerBottomZ;
 }
 
-LineWithIDs LinesBucketQueue::getCurLines() const
+LinesBucketRanges LinesBucketQueue::getCurRanges() const
 {
-    LineWithIDs lines;
+    LinesBucketRanges ranges;
     for (const LinesBucket &bucket : line_buckets) {
         if (bucket.valid()) {
-            LineWithIDs tmpLines = bucket.curLines();
-            lines.insert(lines.end(), tmpLines.begin(), tmpLines.end());
+            auto [b, e] = bucket.curRange();
+            ranges.push_back({ &bucket, b, e });
         }
     }
-    return lines;
+    return ranges;
 }
 
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths)
@@ -195,22 +249,61 @@ ObjectExtrusions getAllLayersExtrusionPathsFromObject(PrintObject *obj)
     return oe;
 }
 
+LineWithIDs ConflictChecker::collect_lines_to_check(const LinesBucketRanges &ranges)
+{
+    // Bounding boxes of the piles per object. Perimeters and supports of the same object share the id and they are never checked against each other.
+    BoundingBoxes                                    range_bboxes;
+    std::vector<std::pair<const void *, BoundingBox>> obj_bboxes;
+    range_bboxes.reserve(ranges.size());
+    for (const LinesBucketRange &range : ranges) {
+        range_bboxes.emplace_back(range.bucket->bounding_box(range.begin, range.end));
+        if (! range_bboxes.back().defined)
+            continue;
+        auto it = std::find_if(obj_bboxes.begin(), obj_bboxes.end(), [&range](const auto &obj_bbox) { return obj_bbox.first == range.bucket->_id; });
+        if (it == obj_bboxes.end())
+            obj_bboxes.emplace_back(range.bucket->_id, range_bboxes.back());
+        else
+            it->second.merge(range_bboxes.back());
+    }
+
+    LineWithIDs lines;
+    if (obj_bboxes.size() < 2)
+        return lines;
+    BoundingBoxes others;
+    for (size_t i = 0; i < ranges.size(); ++ i) {
+        if (! range_bboxes[i].defined)
+            continue;
+        others.clear();
+        for (const auto &[id, bbox] : obj_bboxes)
+            if (id != ranges[i].bucket->_id && bbox.overlap(range_bboxes[i]))
+                others.emplace_back(bbox);
+        // Only lines touching another object's bounding box may collide.
+        if (! others.empty())
+            ranges[i].bucket->lines(ranges[i].begin, ranges[i].end, others, lines);
+    }
+    return lines;
+}
+
 ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines)
 {
     using namespace RasterizationImpl;
-    std::map<IndexPair, std::vector<int>> indexToLine;
-
-    for (int i = 0; i < lines.size(); ++i) {
-        const LineWithID &l1      = lines[i];
-        auto              indexes = line_rasterization(l1._line);
-        for (auto index : indexes) {
-            const auto &possibleIntersectIdxs = indexToLine[index];
-            for (auto possibleIntersectIdx : possibleIntersectIdxs) {
-                const LineWithID &l2 = lines[possibleIntersectIdx];
-                if (auto interRes = line_intersect(l1, l2); interRes.has_value()) { return interRes; }
-            }
-            indexToLine[index].push_back(i);
-        }
+    // Rasterize all lines into (cell, line) pairs and sort them by cell, so that lines sharing a cell end up next to each other.
+    std::vector<std::pair<IndexPair, int>> cells;
+    cells.reserve(lines.size() * 2);
+    for (int i = 0; i < int(lines.size()); ++ i)
+        line_rasterization(lines[i]._line, [&cells, i](const IndexPair &index) { cells.emplace_back(index, i); });
+    std::sort(cells.begin(), cells.end());
+
+    for (auto begin = cells.begin(); begin != cells.end();) {
+        auto end = std::find_if(begin + 1, cells.end(), [&begin](const auto &cell) { return cell.first != begin->first; });
+        const void *id = lines[begin->second]._id;
+        // Skip cells occupied by lines of a single object.
+        if (std::any_of(begin + 1, end, [&lines, id](const auto &cell) { return lines[cell.second]._id != id; }))
+            for (auto it2 = begin + 1; it2 != end; ++ it2)
+                for (auto it1 = begin; it1 != it2; ++ it1)
+                    if (auto interRes = line_intersect(lines[it2->second], lines[it1->second]); interRes.has_value())
+                        return interRes;
+        begin = end;
     }
     return {};
 }
@@ -219,7 +312,7 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(PrintObjectP
                                                                     std::optional<const FakeWipeTower *> wtdptr) // find the first intersection point of lines in different objects
 {
     if (objs.size() <= 1 && !wtdptr) { return {}; }
-    LinesBucketQueue conflictQueue;
+    std::vector<LinesBucket> buckets;
 
     if (wtdptr.has_value()) { // wipe tower at 0 by default
         auto            wtpaths = wtdptr.value()->getFakeExtrusionPathsFromWipeTower2();
@@ -232,40 +325,62 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(PrintObjectP
             el.layer    = nullptr;
             wtels.push_back(el);
         }
-        conflictQueue.emplace_back_bucket(std::move(wtels), wtdptr.value(), {wtdptr.value()->plate_origin.x(), wtdptr.value()->plate_origin.y()});
+        buckets.emplace_back(std::move(wtels), wtdptr.value(), Point(wtdptr.value()->plate_origin.x(), wtdptr.value()->plate_origin.y()));
+    }
+    std::vector<ObjectExtrusions> objs_extrusions(objs.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objs.size()), [&objs, &objs_extrusions](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            objs_extrusions[i] = getAllLayersExtrusionPathsFromObject(objs[i]);
+    });
+    for (size_t i = 0; i < objs.size(); ++ i) {
+        buckets.emplace_back(std::move(objs_extrusions[i].perimeters), objs[i], objs[i]->instances().front().shift);
+        buckets.emplace_back(std::move(objs_extrusions[i].support), objs[i], objs[i]->instances().front().shift);
     }
-    for (PrintObject *obj : objs) {
-        auto layers = getAllLayersExtrusionPathsFromObject(obj);
-        conflictQueue.emplace_back_bucket(std::move(layers.perimeters), obj, obj->instances().front().shift);
-        conflictQueue.emplace_back_bucket(std::move(layers.support), obj, obj->instances().front().shift);
+
+    // Broad phase over the whole print: a bucket, which does not overlap any bucket of another object, cannot collide with anything.
+    BoundingBoxes buckets_bboxes;
+    for (LinesBucket &bucket : buckets) {
+        bucket.update_bounding_boxes();
+        buckets_bboxes.emplace_back(bucket.bounding_box());
     }
+    LinesBucketQueue conflictQueue;
+    for (size_t i = 0; i < buckets.size(); ++ i)
+        for (size_t j = 0; j < buckets.size(); ++ j)
+            if (buckets[i]._id != buckets[j]._id && buckets_bboxes[i].defined && buckets_bboxes[j].defined && buckets_bboxes[i].overlap(buckets_bboxes[j])) {
+                conflictQueue.emplace_back_bucket(std::move(buckets[i]));
+                break;
+            }
 
-    std::vector<LineWithIDs> layersLines;
-    std::vector<float>       bottomZs;
+    std::vector<LinesBucketRanges> layersRanges;
+    std::vector<float>             bottomZs;
     while (conflictQueue.valid()) {
-        LineWithIDs lines = conflictQueue.getCurLines();
+        LinesBucketRanges ranges = conflictQueue.getCurRanges();
         float curBottomZ = conflictQueue.getCurrBottomZ();
         bottomZs.push_back(curBottomZ);
-        layersLines.push_back(std::move(lines));
+        layersRanges.push_back(std::move(ranges));
     }
 
-    bool                                                          find = false;
-    tbb::concurrent_vector<std::pair<ConflictComputeResult, float>> conflict;
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(interRes.value(), bottomZs[i]);
+    // Report the lowest conflicting layer. Layers above a conflict that was already found are not checked at all.
+    std::atomic<size_t>             first_conflict(layersRanges.size());
+    std::vector<ConflictComputeOpt> conflicts(layersRanges.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersRanges.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end() && i < first_conflict.load(std::memory_order_relaxed); ++ i) {
+            LineWithIDs lines = collect_lines_to_check(layersRanges[i]);
+            if (lines.empty())
+                continue;
+            conflicts[i] = find_inter_of_lines(lines);
+            if (conflicts[i].has_value()) {
+                size_t first = first_conflict.load();
+                while (i < first && ! first_conflict.compare_exchange_weak(first, i)) ;
                 break;
             }
         }
     });
 
-    if (find) {
-        const void *ptr1           = conflict[0].first._obj1;
-        const void *ptr2           = conflict[0].first._obj2;
-        float       conflictPrintZ = conflict[0].second;
+    if (size_t i = first_conflict.load(); i < layersRanges.size()) {
+        const void *ptr1           = conflicts[i]->_obj1;
+        const void *ptr2           = conflicts[i]->_obj2;
+        float       conflictPrintZ = bottomZs[i];
         if (wtdptr.has_value()) {
             const FakeWipeTower *wtdp = wtdptr.value();
             if (ptr1 == wtdp || ptr2 == wtdp) {
@@ -59,6 +59,8 @@ public:
     ExtrusionLayers _piles;
     const void*     _id;
     Point           _offset;
+    // XY bounding boxes of the piles, already shifted by _offset. Filled in by update_bounding_boxes().
+    BoundingBoxes   _pileBBoxes;
 
 public:
     LinesBucket(ExtrusionLayers &&paths, const void* id, Point offset) : _piles(paths), _id(id), _offset(offset) {}
@@ -79,22 +81,14 @@ public:
         _curBottomZ = _curPileIdx == _piles.size() ? _piles.back().bottom_z : _piles[_curPileIdx].bottom_z;
     }
     float curBottomZ() const { return _curBottomZ; }
-    LineWithIDs curLines() const
-    {
-        auto [b, e] = curRange();
-        LineWithIDs lines;
-        for (int i = b; i < e; ++i) {
-            for (const ExtrusionPath &path : _piles[i].paths) {
-                if (path.is_force_no_extrusion() == false) {
-                    Polyline check_polyline = path.polyline;
-                    check_polyline.translate(_offset);
-                    Lines tmpLines = check_polyline.lines();
-                    for (const Line &line : tmpLines) { lines.emplace_back(line, _id, path.role()); }
-                }
-            }
-        }
-        return lines;
-    }
+
+    void        update_bounding_boxes();
+    // Bounding box of all piles, undefined if the bucket does not extrude anything.
+    BoundingBox bounding_box() const;
+    // Bounding box of piles <begin, end), requires update_bounding_boxes() to be called first.
+    BoundingBox bounding_box(int begin, int end) const;
+    // Append lines of piles <begin, end), skipping lines whose bounding box does not overlap any of the filter boxes.
+    void        lines(int begin, int end, const BoundingBoxes &filter, LineWithIDs &out) const;
 
     friend bool operator>(const LinesBucket &left, const LinesBucket &right) { return left._curBottomZ > right._curBottomZ; }
     friend bool operator<(const LinesBucket &left, const LinesBucket &right) { return left._curBottomZ < right._curBottomZ; }
@@ -106,6 +100,16 @@ struct LinesBucketPtrComp
     bool operator()(const LinesBucket *left, const LinesBucket *right) { return *left > *right; }
 };
 
+// Piles <begin, end) of a bucket, which are printed together at a single step of LinesBucketQueue.
+struct LinesBucketRange
+{
+    const LinesBucket *bucket;
+    int                begin;
+    int                end;
+};
+
+using LinesBucketRanges = std::vector<LinesBucketRange>;
+
 class LinesBucketQueue
 {
 public:
@@ -113,10 +117,11 @@ public:
     std::priority_queue<LinesBucket *, std::vector<LinesBucket *>, LinesBucketPtrComp> line_bucket_ptr_queue;
 
 public:
-    void        emplace_back_bucket(ExtrusionLayers &&els, const void *objPtr, Point offset);
-    bool        valid() const { return line_bucket_ptr_queue.empty() == false; }
-    float       getCurrBottomZ();
-    LineWithIDs getCurLines() const;
+    void              emplace_back_bucket(ExtrusionLayers &&els, const void *objPtr, Point offset);
+    void              emplace_back_bucket(LinesBucket &&bucket);
+    bool              valid() const { return line_bucket_ptr_queue.empty() == false; }
+    float             getCurrBottomZ();
+    LinesBucketRanges getCurRanges() const;
 };
 
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths);
@@ -143,6 +148,8 @@ using ConflictObjName = std::optional<std::pair<std::string, std::string>>;
 struct ConflictChecker
 {
     static ConflictResultOpt  find_inter_of_lines_in_diff_objs(PrintObjectPtrs objs, std::optional<const FakeWipeTower *> wtdptr);
+    // Broad phase: collect lines of the given piles, which may collide with lines of another object.
+    static LineWithIDs        collect_lines_to_check(const LinesBucketRanges &ranges);
     static ConflictComputeOpt find_inter_of_lines(const LineWithIDs &lines);
     static ConflictComputeOpt line_intersect(const LineWithID &l1, const LineWithID &l2);
 };
@@ -5,10 +5,12 @@
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 #include "tbb/parallel_reduce.h"
+#include "tbb/task_arena.h"
 #include <boost/log/trivial.hpp>
 #include <random>
 #include <algorithm>
 #include <queue>
+#include <unordered_set>
 
 #include "libslic3r/AABBTreeLines.hpp"
 #include "libslic3r/KDTreeIndirect.hpp"
@@ -157,6 +159,9 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                      &raycasting_tree, &result, &samples, seam_position](tbb::blocked_range<size_t> r) {
                       // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
                       std::vector<igl::Hit> hits;
+                      std::vector<igl::Hit> first_hits;
+                      std::vector<Vec3f>    ray_origins;
+                      std::vector<Vec3f>    ray_dirs;
                       for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                         result[s_idx] = 1.0f;
                         constexpr float decrease_step = 1.0f
@@ -173,49 +178,51 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                         Frame f;
                         f.set_from_z(normal);
 
-                        for (const auto &dir : precomputed_sample_directions) {
-                          Vec3f final_ray_dir = (f.to_world(dir));
-                          if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                                                                 triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
+                        if (!model_contains_negative_parts) {
+                          // All the rays of a sample start at the same point, they are coherent enough to be traced in packets.
+                          ray_origins.assign(precomputed_sample_directions.size(), center + normal * 0.01f); // start above surface.
+                          ray_dirs.clear();
+                          for (const auto &dir : precomputed_sample_directions)
+                            ray_dirs.emplace_back(f.to_world(dir));
+                          AABBTreeIndirect::intersect_rays_first_hit(triangles.vertices, triangles.indices, raycasting_tree,
+                                                                     ray_origins, ray_dirs, first_hits);
+                          for (size_t ray_idx = 0; ray_idx < ray_dirs.size(); ++ray_idx)
+                            if (first_hits[ray_idx].id >= 0 &&
+                                its_face_normal(triangles, first_hits[ray_idx].id).dot(ray_dirs[ray_idx]) <= 0)
                               result[s_idx] -= decrease_step;
-                            }
-                          } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                                                >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                              final_ray_dir = -1.0 * final_ray_dir;
-                              ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                                                                     triangles.indices, raycasting_tree,
-                                                                                     ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
-                              int counter = 0;
-                              // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                              //  It cannot be inside model, and it cannot be inside negative volume
-                              for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                  counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                                                                               // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                                } else {
-                                  counter += sgn(face_normal.dot(final_ray_dir));
-                                }
-                              }
-                              if (counter == 0) {
-                                result[s_idx] -= decrease_step;
+                          continue;
+                        }
+
+                        for (const auto &dir : precomputed_sample_directions) { //TODO improve logic for order based boolean operations - consider order of volumes
+                          Vec3f final_ray_dir = (f.to_world(dir));
+                          bool casting_from_negative_volume = samples.triangle_indices[s_idx]
+                                                              >= negative_volumes_start_index;
+
+                          Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                          if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
+                            final_ray_dir = -1.0 * final_ray_dir;
+                            ray_origin_d = (center - normal * 0.01f).cast<double>();
+                          }
+                          Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                          bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
+                                                                                   triangles.indices, raycasting_tree,
+                                                                                   ray_origin_d, final_ray_dir_d, hits);
+                          if (some_hit) {
+                            int counter = 0;
+                            // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                            //  It cannot be inside model, and it cannot be inside negative volume
+                            for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                              Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                              if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
+                                                                                             // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                              } else {
+                                counter += sgn(face_normal.dot(final_ray_dir));
                               }
                             }
+                            if (counter == 0) {
+                              result[s_idx] -= decrease_step;
+                            }
                           }
                         }
                       }
@@ -1128,7 +1135,8 @@ std::optional<std::pair<size_t, size_t>> SeamPlacer::find_next_seam_in_layer(
     const std::vector<PrintObjectSeamData::LayerSeams> &layers,
     const Vec3f &projected_position,
     const size_t layer_idx, const float max_distance,
-    const SeamPlacerImpl::SeamComparator &comparator) const {
+    const SeamPlacerImpl::SeamComparator &comparator,
+    std::vector<const SeamPlacerImpl::Perimeter*> *visited_perimeters) const {
   using namespace SeamPlacerImpl;
   std::vector<size_t> nearby_points_indices = find_nearby_points(*layers[layer_idx].points_tree, projected_position,
                                                                  max_distance);
@@ -1143,6 +1151,9 @@ std::optional<std::pair<size_t, size_t>> SeamPlacer::find_next_seam_in_layer(
   // Now find best nearby point, nearest point, and corresponding indices
   for (const size_t &nearby_point_index : nearby_points_indices) {
     const SeamCandidate &point = layers[layer_idx].points[nearby_point_index];
+    if (visited_perimeters != nullptr && (visited_perimeters->empty() || visited_perimeters->back() != &point.perimeter)) {
+      visited_perimeters->push_back(&point.perimeter);
+    }
     if (point.perimeter.finalized) {
       continue; // skip over finalized perimeters, try to find some that is not finalized
     }
@@ -1189,7 +1200,8 @@ std::optional<std::pair<size_t, size_t>> SeamPlacer::find_next_seam_in_layer(
 }
 
 std::vector<std::pair<size_t, size_t>> SeamPlacer::find_seam_string(const PrintObject *po,
-                                                                    std::pair<size_t, size_t> start_seam, const SeamPlacerImpl::SeamComparator &comparator) const {
+                                                                    std::pair<size_t, size_t> start_seam, const SeamPlacerImpl::SeamComparator &comparator,
+                                                                    std::vector<const SeamPlacerImpl::Perimeter*> *visited_perimeters) const {
   const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second.layers;
   int layer_idx = start_seam.first;
 
@@ -1220,7 +1232,8 @@ std::vector<std::pair<size_t, size_t>> SeamPlacer::find_seam_string(const PrintO
 
     std::optional<std::pair<size_t, size_t>> maybe_next_seam = find_next_seam_in_layer(layers, projected_position,
                                                                                        next_layer,
-                                                                                       max_distance, comparator);
+                                                                                       max_distance, comparator,
+                                                                                       visited_perimeters);
 
     if (maybe_next_seam.has_value()) {
       // For old macOS (pre 10.14), std::optional does not have .value() method, so the code is using operator*() instead.
@@ -1291,188 +1304,259 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
                    }
   );
 
-  //align the seam points - start with the best, and check if they are aligned, if yes, skip, else start alignment
-  // Keeping the vectors outside, so with a bit of luck they will not get reallocated after couple of for loop iterations.
-  std::vector<std::pair<size_t, size_t>> seam_string;
-  std::vector<std::pair<size_t, size_t>> alternative_seam_string;
-  std::vector<Vec2f> observations;
-  std::vector<float> observation_points;
-  std::vector<float> weights;
-
-  int global_index = 0;
-  while (global_index < int(seams.size())) {
-    size_t layer_idx = seams[global_index].first;
-    size_t seam_index = seams[global_index].second;
-    global_index++;
-    const std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
-    if (layer_perimeter_points[seam_index].perimeter.finalized) {
-      // This perimeter is already aligned, skip seam
-      continue;
-    } else {
-      seam_string = this->find_seam_string(po, { layer_idx, seam_index }, comparator);
-      size_t step_size = 1 + seam_string.size() / 20;
-      for (size_t alternative_start = 0; alternative_start < seam_string.size(); alternative_start += step_size) {
-        size_t start_layer_idx = seam_string[alternative_start].first;
-        size_t seam_idx =
-            layers[start_layer_idx].points[seam_string[alternative_start].second].perimeter.seam_index;
-        alternative_seam_string = this->find_seam_string(po,
-                                                         std::pair<size_t, size_t>(start_layer_idx, seam_idx), comparator);
-        if (alternative_seam_string.size() > seam_string.size()) {
-          seam_string = std::move(alternative_seam_string);
-        }
+  // Curve fitting of a single seam string. Only the final_seam_position of the perimeters of the string is written,
+  // strings never share a perimeter, thus the strings may be fitted concurrently.
+  auto fit_seam_string = [&layers, &comparator](const std::vector<std::pair<size_t, size_t>> &seam_string) {
+    // gather all positions of seams and their weights
+    std::vector<Vec2f> observations(seam_string.size());
+    std::vector<float> observation_points(seam_string.size());
+    std::vector<float> weights(seam_string.size());
+
+    auto angle_3d = [](const Vec3f& a, const Vec3f& b){
+      return std::abs(acosf(a.normalized().dot(b.normalized())));
+    };
+
+    auto angle_weight = [](float angle){
+      return 1.0f / (0.1f + compute_angle_penalty(angle));
+    };
+
+    //gather points positions and weights
+    float total_length = 0.0f;
+    Vec3f last_point_pos = layers[seam_string[0].first].points[seam_string[0].second].position;
+    for (size_t index = 0; index < seam_string.size(); ++index) {
+      const SeamCandidate &current = layers[seam_string[index].first].points[seam_string[index].second];
+      float layer_angle = 0.0f;
+      if (index > 0 && index < seam_string.size() - 1) {
+        layer_angle = angle_3d(
+            current.position
+                - layers[seam_string[index - 1].first].points[seam_string[index - 1].second].position,
+            layers[seam_string[index + 1].first].points[seam_string[index + 1].second].position
+                - current.position
+        );
       }
-      if (seam_string.size() < seam_align_minimum_string_seams) {
-        //string NOT long enough to be worth aligning, skip
-        continue;
+      observations[index] = current.position.head<2>();
+      observation_points[index] = current.position.z();
+      weights[index] = angle_weight(current.local_ccw_angle);
+      float curling_influence = layer_angle > 2.0 * std::abs(current.local_ccw_angle) ? -0.8f : 1.0f;
+      if (current.type == EnforcedBlockedSeamPoint::Enforced) {
+        curling_influence = 1.0f;
+        weights[index] += 3.0f;
       }
+      total_length += curling_influence * (last_point_pos - current.position).norm();
+      last_point_pos = current.position;
+    }
 
-      // String is long enough, all string seams and potential string seams gathered, now do the alignment
-      //sort by layer index
-      std::sort(seam_string.begin(), seam_string.end(),
-                [](const std::pair<size_t, size_t> &left, const std::pair<size_t, size_t> &right) {
-                  return left.first < right.first;
-                });
+    if (comparator.setup == spRear) {
+      total_length *= 0.3f;
+    }
 
-      //repeat the alignment for the current seam, since it could be skipped due to alternative path being aligned.
-      global_index--;
+    // Curve Fitting
+    size_t number_of_segments = std::max(size_t(1),
+                                         size_t(std::max(0.0f,total_length) / SeamPlacer::seam_align_mm_per_segment));
+    auto curve = Geometry::fit_cubic_bspline(observations, observation_points, weights, number_of_segments);
+
+    // Do alignment - compute fitted point for each point in the string from its Z coord, and store the position into
+    // Perimeter structure of the point
+    for (size_t index = 0; index < seam_string.size(); ++index) {
+      const auto &pair = seam_string[index];
+      float t = std::min(1.0f, std::pow(std::abs(layers[pair.first].points[pair.second].local_ccw_angle)
+                                            / SeamPlacer::sharp_angle_snapping_threshold, 3.0f));
+      if (layers[pair.first].points[pair.second].type == EnforcedBlockedSeamPoint::Enforced){
+        t = std::max(0.4f, t);
+      }
 
-      // gather all positions of seams and their weights
-      observations.resize(seam_string.size());
-      observation_points.resize(seam_string.size());
-      weights.resize(seam_string.size());
+      Vec3f current_pos = layers[pair.first].points[pair.second].position;
+      Vec2f fitted_pos = curve.get_fitted_value(current_pos.z());
 
-      auto angle_3d = [](const Vec3f& a, const Vec3f& b){
-        return std::abs(acosf(a.normalized().dot(b.normalized())));
-      };
+      //interpolate between current and fitted position, prefer current pos for large weights.
+      Vec3f final_position = t * current_pos + (1.0f - t) * to_3d(fitted_pos, current_pos.z());
 
-      auto angle_weight = [](float angle){
-        return 1.0f / (0.1f + compute_angle_penalty(angle));
-      };
+      layers[pair.first].points[pair.second].perimeter.final_seam_position = final_position;
+    }
+  };
 
-      //gather points positions and weights
-      float total_length = 0.0f;
-      Vec3f last_point_pos = layers[seam_string[0].first].points[seam_string[0].second].position;
-      for (size_t index = 0; index < seam_string.size(); ++index) {
-        const SeamCandidate &current = layers[seam_string[index].first].points[seam_string[index].second];
-        float layer_angle = 0.0f;
-        if (index > 0 && index < seam_string.size() - 1) {
-          layer_angle = angle_3d(
-              current.position
-                  - layers[seam_string[index - 1].first].points[seam_string[index - 1].second].position,
-              layers[seam_string[index + 1].first].points[seam_string[index + 1].second].position
-                  - current.position
-          );
-        }
-        observations[index] = current.position.head<2>();
-        observation_points[index] = current.position.z();
-        weights[index] = angle_weight(current.local_ccw_angle);
-        float curling_influence = layer_angle > 2.0 * std::abs(current.local_ccw_angle) ? -0.8f : 1.0f;
-        if (current.type == EnforcedBlockedSeamPoint::Enforced) {
-          curling_influence = 1.0f;
-          weights[index] += 3.0f;
-        }
-        total_length += curling_influence * (last_point_pos - current.position).norm();
-        last_point_pos = current.position;
+  struct SeamStringSearch {
+    std::vector<std::pair<size_t, size_t>> seam_string;
+    // Perimeters, whose state was read while searching for the seam_string. Sorted.
+    std::vector<const Perimeter*> visited_perimeters;
+  };
+
+  // Searches for the longest string through the given seam, trying alternative starts along the first string found.
+  // Does not modify any perimeter, thus it may run concurrently.
+  auto search_seam_string = [this, po, &layers, &comparator](const std::pair<size_t, size_t> &start_seam,
+                                                             SeamStringSearch &search) {
+    search.visited_perimeters.clear();
+    search.visited_perimeters.push_back(&layers[start_seam.first].points[start_seam.second].perimeter);
+    search.seam_string = this->find_seam_string(po, start_seam, comparator, &search.visited_perimeters);
+    size_t step_size = 1 + search.seam_string.size() / 20;
+    for (size_t alternative_start = 0; alternative_start < search.seam_string.size(); alternative_start += step_size) {
+      size_t start_layer_idx = search.seam_string[alternative_start].first;
+      size_t seam_idx =
+          layers[start_layer_idx].points[search.seam_string[alternative_start].second].perimeter.seam_index;
+      std::vector<std::pair<size_t, size_t>> alternative_seam_string = this->find_seam_string(po,
+          std::pair<size_t, size_t>(start_layer_idx, seam_idx), comparator, &search.visited_perimeters);
+      if (alternative_seam_string.size() > search.seam_string.size()) {
+        search.seam_string = std::move(alternative_seam_string);
       }
+    }
+    sort_remove_duplicates(search.visited_perimeters);
+  };
 
-      if (comparator.setup == spRear) {
-        total_length *= 0.3f;
+  //align the seam points - start with the best, and check if they are aligned, if yes, skip, else start alignment
+  // The strings are searched for speculatively, for a batch of the next not yet finalized seams in parallel.
+  // The batch is then committed serially in the sorted order of the seams. A search result is only used if none of
+  // the perimeters it has visited was finalized by a string committed earlier in the same batch, otherwise the batch
+  // is cut short and the search is repeated at the start of the next batch. Thus the strings found are exactly
+  // the same as if the seams were processed one by one.
+  // With spAssemble_zgap, committing a string blocks nearby points and moves the seams of other perimeters,
+  // therefore the seams are processed one at a time and each string is fitted right when it is committed.
+  const bool   assemble_zgap = configured_seam_preference == spAssemble_zgap;
+  const size_t batch_size    = assemble_zgap ? 1 : 4 * size_t(std::max(1, tbb::this_task_arena::max_concurrency()));
+
+  std::vector<size_t> batch;
+  std::vector<SeamStringSearch> searches;
+  std::unordered_set<const Perimeter*> committed_perimeters;
+  std::vector<std::vector<std::pair<size_t, size_t>>> seam_strings;
+
+  size_t global_index = 0;
+  while (global_index < seams.size()) {
+    batch.clear();
+    for (size_t index = global_index; index < seams.size() && batch.size() < batch_size; ++index) {
+      if (!layers[seams[index].first].points[seams[index].second].perimeter.finalized) {
+        batch.push_back(index);
       }
+    }
+    if (batch.empty()) {
+      break;
+    }
 
-      // Curve Fitting
-      size_t number_of_segments = std::max(size_t(1),
-                                           size_t(std::max(0.0f,total_length) / SeamPlacer::seam_align_mm_per_segment));
-      auto curve = Geometry::fit_cubic_bspline(observations, observation_points, weights, number_of_segments);
-
-      // Do alignment - compute fitted point for each point in the string from its Z coord, and store the position into
-      // Perimeter structure of the point; also set flag aligned to true
-      for (size_t index = 0; index < seam_string.size(); ++index) {
-        const auto &pair = seam_string[index];
-        float t = std::min(1.0f, std::pow(std::abs(layers[pair.first].points[pair.second].local_ccw_angle)
-                                              / SeamPlacer::sharp_angle_snapping_threshold, 3.0f));
-        if (layers[pair.first].points[pair.second].type == EnforcedBlockedSeamPoint::Enforced){
-          t = std::max(0.4f, t);
-        }
+    searches.resize(batch.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batch.size()), [&](const tbb::blocked_range<size_t> &range) {
+      for (size_t index = range.begin(); index < range.end(); ++index) {
+        search_seam_string(seams[batch[index]], searches[index]);
+      }
+    });
 
-        Vec3f current_pos = layers[pair.first].points[pair.second].position;
-        Vec2f fitted_pos = curve.get_fitted_value(current_pos.z());
+    committed_perimeters.clear();
+    global_index = batch.back() + 1;
+    for (size_t batch_index = 0; batch_index < batch.size(); ++batch_index) {
+      const std::pair<size_t, size_t> &seam = seams[batch[batch_index]];
+      if (layers[seam.first].points[seam.second].perimeter.finalized) {
+        // This perimeter has been aligned by a string committed earlier in this batch, skip seam
+        continue;
+      }
+      SeamStringSearch &search = searches[batch_index];
+      if (std::any_of(search.visited_perimeters.begin(), search.visited_perimeters.end(),
+                      [&committed_perimeters](const Perimeter *perimeter) {
+                        return committed_perimeters.count(perimeter) > 0;
+                      })) {
+        // The search has seen a perimeter, which got finalized since. Search again in the next batch.
+        global_index = batch[batch_index];
+        break;
+      }
+      if (search.seam_string.size() < seam_align_minimum_string_seams) {
+        //string NOT long enough to be worth aligning, skip
+        continue;
+      }
 
-        //interpolate between current and fitted position, prefer current pos for large weights.
-        Vec3f final_position = t * current_pos + (1.0f - t) * to_3d(fitted_pos, current_pos.z());
+      // String is long enough, all string seams and potential string seams gathered, now do the alignment
+      //sort by layer index
+      std::vector<std::pair<size_t, size_t>> &seam_string = search.seam_string;
+      std::sort(seam_string.begin(), seam_string.end(),
+                [](const std::pair<size_t, size_t> &left, const std::pair<size_t, size_t> &right) {
+                  return left.first < right.first;
+                });
 
+      // Pick the seam of each perimeter of the string and set flag aligned to true
+      for (const std::pair<size_t, size_t> &pair : seam_string) {
         Perimeter &perimeter = layers[pair.first].points[pair.second].perimeter;
         perimeter.seam_index = pair.second;
-        perimeter.final_seam_position = final_position;
         perimeter.finalized = true;
+        committed_perimeters.insert(&perimeter);
+      }
 
-        if (configured_seam_preference == spAssemble_zgap)
-        {
-            std::vector<size_t> nearby_points_indices = find_nearby_points(*layers[pair.first].points_tree, final_position, 2.0f);
-            for (auto& pid : nearby_points_indices) {
-                layers[pair.first].points[pid].type = EnforcedBlockedSeamPoint ::Blocked;
-            }
+      if (assemble_zgap) {
+        fit_seam_string(seam_string);
+        for (const std::pair<size_t, size_t> &pair : seam_string) {
+          std::vector<size_t> nearby_points_indices = find_nearby_points(*layers[pair.first].points_tree,
+              layers[pair.first].points[pair.second].perimeter.final_seam_position, 2.0f);
+          for (auto& pid : nearby_points_indices) {
+            layers[pair.first].points[pid].type = EnforcedBlockedSeamPoint ::Blocked;
+          }
         }
 
+        auto getNextCandSeamidx = [&](SeamPlacerImpl::Perimeter& cur_perimeter, int next_cand_idx) {
+            return cur_perimeter.candidate_seam_indexs[next_cand_idx];
+        };
+
+        std::for_each(seams.begin(), seams.end(), [&](std::pair<size_t, size_t>& x) {
+            if (!layers[x.first].points[x.second].perimeter.finalized) {
+                if (layers[x.first].points[x.second].type == EnforcedBlockedSeamPoint::Blocked) {
+                    SeamPlacerImpl::Perimeter& perimeterx = layers[x.first].points[x.second].perimeter;
+                    int                        seamidx    = perimeterx.seam_index;
+                    int                        loops      = 0;
+                    do {
+                        seamidx = getNextCandSeamidx(perimeterx, loops);
+                        loops++;
+                        if (loops == perimeterx.end_index - perimeterx.start_index - 1) {
+                            break;
+                        }
+
+                    } while (layers[x.first].points[seamidx].type == EnforcedBlockedSeamPoint::Blocked);
+                    if (layers[x.first].points[seamidx].type != EnforcedBlockedSeamPoint::Blocked) {
+                        perimeterx.seam_index = seamidx;
+                        x.second              = seamidx;
+                    } else {
+                        int x = 0;
+                        x++;
+                    }
+                }
+            }
+        });
       }
 
-     if (configured_seam_preference == spAssemble_zgap) {
-
-          auto getNextCandSeamidx = [&](SeamPlacerImpl::Perimeter& cur_perimeter, int next_cand_idx) {
-              return cur_perimeter.candidate_seam_indexs[next_cand_idx];
-          };
-
-          std::for_each(seams.begin(), seams.end(), [&](std::pair<size_t, size_t>& x) {
-              if (!layers[x.first].points[x.second].perimeter.finalized) {
-                  if (layers[x.first].points[x.second].type == EnforcedBlockedSeamPoint::Blocked) {
-                      SeamPlacerImpl::Perimeter& perimeterx = layers[x.first].points[x.second].perimeter;
-                      int                        seamidx    = perimeterx.seam_index;
-                      int                        loops      = 0;
-                      do {
-                          seamidx = getNextCandSeamidx(perimeterx, loops);
-                          loops++;
-                          if (loops == perimeterx.end_index - perimeterx.start_index - 1) {
-                              break;
-                          }
+      seam_strings.emplace_back(std::move(seam_string));
 
-                      } while (layers[x.first].points[seamidx].type == EnforcedBlockedSeamPoint::Blocked);
-                      if (layers[x.first].points[seamidx].type != EnforcedBlockedSeamPoint::Blocked) {
-                          perimeterx.seam_index = seamidx;
-                          x.second              = seamidx;
-                      } else {
-                          int x = 0;
-                          x++;
-                      }
-                  }
-              }
-          });
+      //repeat the alignment for the current seam, since it could be skipped due to alternative path being aligned.
+      if (!layers[seam.first].points[seam.second].perimeter.finalized) {
+        global_index = batch[batch_index];
+        break;
       }
+    }
+  }
 
-#ifdef DEBUG_FILES
-      auto randf = []() {
-        return float(rand()) / float(RAND_MAX);
-      };
-      Vec3f color { randf(), randf(), randf() };
-      for (size_t i = 0; i < seam_string.size(); ++i) {
-        auto orig_seam = layers[seam_string[i].first].points[seam_string[i].second];
-        fprintf(clusters, "v %f %f %f %f %f %f \n", orig_seam.position[0],
-                orig_seam.position[1],
-                orig_seam.position[2], color[0], color[1],
-                color[2]);
+  if (!assemble_zgap) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, seam_strings.size()), [&](const tbb::blocked_range<size_t> &range) {
+      for (size_t index = range.begin(); index < range.end(); ++index) {
+        fit_seam_string(seam_strings[index]);
       }
+    });
+  }
 
-      color = Vec3f { randf(), randf(), randf() };
-      for (size_t i = 0; i < seam_string.size(); ++i) {
-        const Perimeter &perimeter = layers[seam_string[i].first].points[seam_string[i].second].perimeter;
-        fprintf(aligns, "v %f %f %f %f %f %f \n", perimeter.final_seam_position[0],
-                perimeter.final_seam_position[1],
-                perimeter.final_seam_position[2], color[0], color[1],
-                color[2]);
-      }
-#endif
+#ifdef DEBUG_FILES
+  auto randf = []() {
+    return float(rand()) / float(RAND_MAX);
+  };
+  for (const std::vector<std::pair<size_t, size_t>> &seam_string : seam_strings) {
+    Vec3f color { randf(), randf(), randf() };
+    for (size_t i = 0; i < seam_string.size(); ++i) {
+      auto orig_seam = layers[seam_string[i].first].points[seam_string[i].second];
+      fprintf(clusters, "v %f %f %f %f %f %f \n", orig_seam.position[0],
+              orig_seam.position[1],
+              orig_seam.position[2], color[0], color[1],
+              color[2]);
+    }
+
+    color = Vec3f { randf(), randf(), randf() };
+    for (size_t i = 0; i < seam_string.size(); ++i) {
+      const Perimeter &perimeter = layers[seam_string[i].first].points[seam_string[i].second].perimeter;
+      fprintf(aligns, "v %f %f %f %f %f %f \n", perimeter.final_seam_position[0],
+              perimeter.final_seam_position[1],
+              perimeter.final_seam_position[2], color[0], color[1],
+              color[2]);
     }
   }
 
-#ifdef DEBUG_FILES
   fclose(clusters);
   fclose(aligns);
 #endif
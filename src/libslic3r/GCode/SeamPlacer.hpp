@@ -151,14 +151,17 @@ private:
                                        const SeamPlacerImpl::GlobalModelInfo &global_model_info);
   void calculate_overhangs_and_layer_embedding(const PrintObject *po);
   void align_seam_points(const PrintObject *po, const SeamPlacerImpl::SeamComparator &comparator);
+  // If visited_perimeters is set, all perimeters whose state was read by the search are appended to it.
   std::vector<std::pair<size_t, size_t>> find_seam_string(const PrintObject *po,
                                                           std::pair<size_t, size_t> start_seam,
-                                                          const SeamPlacerImpl::SeamComparator &comparator) const;
+                                                          const SeamPlacerImpl::SeamComparator &comparator,
+                                                          std::vector<const SeamPlacerImpl::Perimeter*> *visited_perimeters = nullptr) const;
   std::optional<std::pair<size_t, size_t>> find_next_seam_in_layer(
       const std::vector<PrintObjectSeamData::LayerSeams> &layers,
       const Vec3f& projected_position,
       const size_t layer_idx, const float max_distance,
-      const SeamPlacerImpl::SeamComparator &comparator) const;
+      const SeamPlacerImpl::SeamComparator &comparator,
+      std::vector<const SeamPlacerImpl::Perimeter*> *visited_perimeters = nullptr) const;
 };
 
 } // namespace Slic3r
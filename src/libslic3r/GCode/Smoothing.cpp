@@ -96,8 +96,9 @@ float SmoothCalculator::recaculate_layer_time(int layer_id, std::vector<PerExtru
 
 void SmoothCalculator::init_object_node_range()
 {
+    // first layer don't need to be smoothed, only the layers appended since the last call are added.
     for (size_t object_id = 0; object_id < objects_node_range.size(); ++object_id) {
-        for (size_t layer_id = 1; layer_id < layers_wall_collection.size(); ++layer_id) {
+        for (size_t layer_id = ranged_layers; layer_id < layers_wall_collection.size(); ++layer_id) {
             const OutwallCollection& each_object = layers_wall_collection[layer_id][object_id];
             auto                     it          = each_object.cooling_nodes.begin();
             while (it != each_object.cooling_nodes.end()) {
@@ -110,26 +111,42 @@ void SmoothCalculator::init_object_node_range()
             }
         }
     }
+    ranged_layers = std::max(ranged_layers, int(layers_wall_collection.size()));
 }
 
-void SmoothCalculator::smooth_layer_speed()
+void SmoothCalculator::smooth_layer_speed(int first_open_layer)
 {
     init_object_node_range();
 
     for (size_t obj_id = 0; obj_id < objects_node_range.size(); ++obj_id) {
         auto it = objects_node_range[obj_id].begin();
         while (it != objects_node_range[obj_id].end()) {
-            int step_count = 0;
-            while (step_count < max_steps_count && speed_filter_continue(obj_id, it->first)) {
-                step_count++;
-                layer_speed_filter(obj_id, it->first);
+            // Nodes ending below the open layers are final.
+            if (it->second.second >= first_open_layer) {
+                int step_count = 0;
+                while (step_count < max_steps_count && speed_filter_continue(obj_id, it->first, first_open_layer)) {
+                    step_count++;
+                    layer_speed_filter(obj_id, it->first, first_open_layer);
+                }
             }
             it++;
         }
     }
 }
 
-void SmoothCalculator::layer_speed_filter(const int object_id, const int node_id)
+void SmoothCalculator::release_layers(int layer_end)
+{
+    // The filter reads up to half of its window below the first open layer.
+    layer_end = std::min(layer_end - int(guassian_filter.size() / 2) - 1, int(layers_wall_collection.size()));
+    for (; released_layers < layer_end; ++released_layers)
+        for (OutwallCollection &object_level : layers_wall_collection[released_layers])
+            for (auto &node : object_level.cooling_nodes) {
+                node.second.outwall_line.clear();
+                node.second.outwall_line.shrink_to_fit();
+            }
+}
+
+void SmoothCalculator::layer_speed_filter(const int object_id, const int node_id, const int first_open_layer)
 {
     int start_pos = guassian_filter.size() / 2;
     // first layer don't need to be smoothed
@@ -137,7 +154,7 @@ void SmoothCalculator::layer_speed_filter(const int object_id, const int node_id
     int layer_end   = objects_node_range[object_id][node_id].second;
 
     // BBS: some layers may empty as the support has indenpendent layer
-    for (int layer_id = layer_start; layer_id <= layer_end; ++layer_id) {
+    for (int layer_id = std::max(layer_start, first_open_layer); layer_id <= layer_end; ++layer_id) {
         if (layers_wall_collection[layer_id].empty())
             continue;
 
@@ -171,11 +188,17 @@ void SmoothCalculator::layer_speed_filter(const int object_id, const int node_id
     }
 }
 
-bool SmoothCalculator::speed_filter_continue(const int object_id, const int node_id)
+bool SmoothCalculator::speed_filter_continue(const int object_id, const int node_id, const int first_open_layer)
 {
-    int layer_id  = objects_node_range[object_id][node_id].first;
+    int layer_id  = std::max(objects_node_range[object_id][node_id].first, first_open_layer);
     int layer_end = objects_node_range[object_id][node_id].second;
 
+    // The last final layer can not be slowed down anymore, only an open layer faster than it is filtered.
+    if (layer_id > objects_node_range[object_id][node_id].first && layer_id <= layer_end &&
+        layers_wall_collection[layer_id][object_id].cooling_nodes[node_id].filter_feedrate -
+        layers_wall_collection[layer_id - 1][object_id].cooling_nodes[node_id].filter_feedrate > guassian_stop_threshold)
+        return true;
+
     // BBS: some layers may empty as the support has indenpendent layer
     for (; layer_id < layer_end; ++layer_id) {
         if (std::abs(layers_wall_collection[layer_id + 1][object_id].cooling_nodes[node_id].filter_feedrate -
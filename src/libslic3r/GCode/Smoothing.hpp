@@ -11,6 +11,10 @@ static const int   guassian_r                         = 2;
 static const int   guassian_stop_threshold            = 5;
 static const float guassian_layer_time_stop_threshold = 3.0;
 static const int   max_steps_count                    = 1000;
+// Number of layers the outer wall speed smoothing looks ahead before the speed of a layer is final.
+// A slow down reaches at least this many layers below it, but never the layers more than twice as many layers below.
+// Smoothing all layers at once may spread a deep slow down further down.
+static const int   smoothing_lookahead_layers         = 64;
 
 struct CoolingNode
 {
@@ -53,6 +57,9 @@ public:
     }
 
     void append_data(const std::vector<OutwallCollection>& wall_collection) { layers_wall_collection.push_back(wall_collection); }
+    void append_data(std::vector<OutwallCollection>&& wall_collection) { layers_wall_collection.push_back(std::move(wall_collection)); }
+
+    int layers_count() const { return int(layers_wall_collection.size()); }
 
     void build_node(std::vector<OutwallCollection>&            wall_collection,
                     const std::vector<int>&                    object_label,
@@ -60,7 +67,12 @@ public:
 
     float recaculate_layer_time(int layer_id, std::vector<PerExtruderAdjustments>& extruder_adjustments);
 
-    void smooth_layer_speed();
+    // Smooth the outer wall speed of the layers starting with first_open_layer. The speed of the layers below is final,
+    // those layers are only used as the boundary of the filter. Layers may be appended between the calls.
+    void smooth_layer_speed(int first_open_layer = 0);
+
+    // Release the outer wall lines of the layers below layer_end, which are neither rewritten nor filtered anymore.
+    void release_layers(int layer_end);
 
 private:
     // guassian filter
@@ -80,9 +92,9 @@ private:
     void init_object_node_range();
 
     // filter the data
-    void layer_speed_filter(const int object_id, const int node_id);
+    void layer_speed_filter(const int object_id, const int node_id, const int first_open_layer);
 
-    bool speed_filter_continue(const int object_id, const int node_id);
+    bool speed_filter_continue(const int object_id, const int node_id, const int first_open_layer);
 
     // filter the data
     void filter_layer_time();
@@ -93,6 +105,10 @@ private:
     std::vector<double> guassian_filter;
     double              filter_sum                     = .0f;
     float               layer_time_smoothing_threshold = 30.0f;
+    // Number of layers already accounted for in objects_node_range.
+    int                 ranged_layers                  = 1;
+    // Number of layers whose outer wall lines were released.
+    int                 released_layers                = 0;
 };
 
 } // namespace Slic3r
@@ -4,6 +4,9 @@
 #include "ClipperUtils.hpp"
 #include "ParameterUtils.hpp"
 
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
 // #define SLIC3R_DEBUG
 
 // Make assert active if SLIC3R_DEBUG
@@ -448,169 +451,179 @@ void ToolOrdering::initialize_layers(std::vector<coordf_t> &zs)
 // Collect extruders reuqired to print layers.
 void ToolOrdering::collect_extruders(const PrintObject &object, const std::vector<std::pair<double, unsigned int>> &per_layer_extruder_switches)
 {
-    // Collect the support extruders.
-    for (auto support_layer : object.support_layers()) 
-    {
-        LayerTools   &layer_tools = this->tools_for_layer(support_layer->print_z);
-        ExtrusionRole role = support_layer->support_fills.role();
-
-        bool          has_support = false;
-        bool          has_interface = false;
-        for (const ExtrusionEntity* ee : support_layer->support_fills.entities) 
-        {
-            ExtrusionRole er = ee->role();
-            if (er == erSupportMaterial || er == erSupportTransition) has_support = true;
-            if (er == erSupportMaterialInterface) has_interface = true;
-            if (has_support && has_interface) break;
-        }
+    // Each support layer and each object layer of a single object is assigned a LayerTools of its own,
+    // thus the layers are processed in parallel. Support layers are processed first, as they were before,
+    // since the support extruders depend on has_object set by the previously collected objects.
 
-        unsigned int extruder_support   = object.config().support_filament.value;
-        unsigned int extruder_interface = object.config().support_interface_filament.value;
-        if (has_support)
-        {
-            if (extruder_support > 0 || !has_interface || extruder_interface == 0 || layer_tools.has_object)
+    // Collect the support extruders.
+    ConstSupportLayerPtrsAdaptor support_layers = object.support_layers();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, support_layers.size()), [this, &object, &support_layers](const tbb::blocked_range<size_t> &range) {
+        for (size_t support_layer_idx = range.begin(); support_layer_idx < range.end(); ++ support_layer_idx) {
+            const SupportLayer *support_layer = support_layers[support_layer_idx];
+            LayerTools   &layer_tools = this->tools_for_layer(support_layer->print_z);
+            ExtrusionRole role = support_layer->support_fills.role();
+
+            bool          has_support = false;
+            bool          has_interface = false;
+            for (const ExtrusionEntity* ee : support_layer->support_fills.entities) 
             {
-                layer_tools.extruders.push_back(extruder_support);
+                ExtrusionRole er = ee->role();
+                if (er == erSupportMaterial || er == erSupportTransition) has_support = true;
+                if (er == erSupportMaterialInterface) has_interface = true;
+                if (has_support && has_interface) break;
             }
-            else 
+
+            unsigned int extruder_support   = object.config().support_filament.value;
+            unsigned int extruder_interface = object.config().support_interface_filament.value;
+            if (has_support)
             {
-                auto all_extruders = object.print()->extruders();
-                auto get_next_extruder = [&](int current_extruder, const std::vector<unsigned int>& extruders) 
+                if (extruder_support > 0 || !has_interface || extruder_interface == 0 || layer_tools.has_object)
                 {
-                    std::vector<float> flush_matrix(
-                        cast<float>(get_flush_volumes_matrix(object.print()->config().flush_volumes_matrix.values, 0, object.print()->config().nozzle_diameter.values.size())));
-                    
-                    const unsigned int number_of_extruders = (unsigned int)(sqrt(flush_matrix.size()) + EPSILON);
-                    
-                    // Extract purging volumes for each extruder pair:
-                    std::vector<std::vector<float>> wipe_volumes;
-                    for (unsigned int i = 0; i < number_of_extruders; ++i)
-                    {
-                        wipe_volumes.push_back(std::vector<float>(flush_matrix.begin() + i * number_of_extruders, flush_matrix.begin() + (i + 1) * number_of_extruders));
-                    }
-                    
-                    int   next_extruder = current_extruder;
-                    float min_flush = std::numeric_limits<float>::max();
-                    for (auto extruder_id : extruders)
+                    layer_tools.extruders.push_back(extruder_support);
+                }
+                else 
+                {
+                    auto all_extruders = object.print()->extruders();
+                    auto get_next_extruder = [&](int current_extruder, const std::vector<unsigned int>& extruders) 
                     {
-                        if (object.print()->config().filament_soluble.get_at(extruder_id) || extruder_id == current_extruder) continue;
+                        std::vector<float> flush_matrix(
+                            cast<float>(get_flush_volumes_matrix(object.print()->config().flush_volumes_matrix.values, 0, object.print()->config().nozzle_diameter.values.size())));
                         
-                        if (wipe_volumes[extruder_interface - 1][extruder_id] < min_flush)
+                        const unsigned int number_of_extruders = (unsigned int)(sqrt(flush_matrix.size()) + EPSILON);
+                        
+                        // Extract purging volumes for each extruder pair:
+                        std::vector<std::vector<float>> wipe_volumes;
+                        for (unsigned int i = 0; i < number_of_extruders; ++i)
                         {
-                            next_extruder = extruder_id;
-                            min_flush = wipe_volumes[extruder_interface - 1][extruder_id];
+                            wipe_volumes.push_back(std::vector<float>(flush_matrix.begin() + i * number_of_extruders, flush_matrix.begin() + (i + 1) * number_of_extruders));
                         }
-                    }
-                    return next_extruder;
-                };
+                        
+                        int   next_extruder = current_extruder;
+                        float min_flush = std::numeric_limits<float>::max();
+                        for (auto extruder_id : extruders)
+                        {
+                            if (object.print()->config().filament_soluble.get_at(extruder_id) || extruder_id == current_extruder) continue;
+                            
+                            if (wipe_volumes[extruder_interface - 1][extruder_id] < min_flush)
+                            {
+                                next_extruder = extruder_id;
+                                min_flush = wipe_volumes[extruder_interface - 1][extruder_id];
+                            }
+                        }
+                        return next_extruder;
+                    };
 
-                bool interface_not_for_body = object.config().support_interface_not_for_body;
-                layer_tools.extruders.push_back(get_next_extruder(interface_not_for_body ? extruder_interface - 1 : -1, all_extruders) + 1);
+                    bool interface_not_for_body = object.config().support_interface_not_for_body;
+                    layer_tools.extruders.push_back(get_next_extruder(interface_not_for_body ? extruder_interface - 1 : -1, all_extruders) + 1);
+                }
+            }
+            
+            if (has_interface)
+            {
+                layer_tools.extruders.push_back(extruder_interface);
+            }
+            
+            if (has_support || has_interface) 
+            {
+                layer_tools.has_support = true;
+                layer_tools.wiping_extrusions().is_support_overriddable_and_mark(role, object);
             }
         }
-        
-        if (has_interface)
-        {
-            layer_tools.extruders.push_back(extruder_interface);
-        }
-        
-        if (has_support || has_interface) 
-        {
-            layer_tools.has_support = true;
-            layer_tools.wiping_extrusions().is_support_overriddable_and_mark(role, object);
-        }
-    }
+    });
 
-    // Extruder overrides are ordered by print_z.
-    std::vector<std::pair<double, unsigned int>>::const_iterator it_per_layer_extruder_override;
-	it_per_layer_extruder_override = per_layer_extruder_switches.begin();
-    unsigned int extruder_override = 0;
+    // Extruder overrides are ordered by print_z. Returns the last override starting below print_z, zero if none.
+    auto extruder_override_for_layer = [&per_layer_extruder_switches](coordf_t print_z) -> unsigned int {
+        auto it = std::lower_bound(per_layer_extruder_switches.begin(), per_layer_extruder_switches.end(), print_z + EPSILON,
+            [](const std::pair<double, unsigned int> &extruder_switch, double z) { return extruder_switch.first < z; });
+        return it == per_layer_extruder_switches.begin() ? 0 : (unsigned int)(int)std::prev(it)->second;
+    };
 
     // BBS: collect first layer extruders of an object's wall, which will be used by brim generator
-    int layerCount = 0;
     std::vector<int> firstLayerExtruders;
-    firstLayerExtruders.clear();
 
     bool ignore_inner_color = object.print()->config().ignore_inner_color.value;
 
     // Collect the object extruders.
-    for (auto layer : object.layers()) {
-        LayerTools &layer_tools = this->tools_for_layer(layer->print_z);
+    ConstLayerPtrsAdaptor object_layers = object.layers();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, object_layers.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer *layer       = object_layers[layer_idx];
+            LayerTools  &layer_tools = this->tools_for_layer(layer->print_z);
 
-        // Override extruder with the next 
-    	for (; it_per_layer_extruder_override != per_layer_extruder_switches.end() && it_per_layer_extruder_override->first < layer->print_z + EPSILON; ++ it_per_layer_extruder_override)
-    		extruder_override = (int)it_per_layer_extruder_override->second;
+            // Override extruder with the next 
+            unsigned int extruder_override = extruder_override_for_layer(layer->print_z);
 
-        // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
-        layer_tools.extruder_override = extruder_override;
+            // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
+            layer_tools.extruder_override = extruder_override;
 
-        // What extruders are required to print this object layer?
-        for (const LayerRegion *layerm : layer->regions()) {
-            const PrintRegion &region = layerm->region();
+            // What extruders are required to print this object layer?
+            for (const LayerRegion *layerm : layer->regions()) {
+                const PrintRegion &region = layerm->region();
 
-            if(ignore_inner_color && layerm->all_inner)
-                continue;
-                
-            if (! layerm->perimeters.entities.empty()) {
-                bool something_nonoverriddable = true;
-
-                if (m_print_config_ptr) { // in this case print->config().print_sequence != PrintSequence::ByObject (see ToolOrdering constructors)
-                    something_nonoverriddable = false;
-                    for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
-                        if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
-                            something_nonoverriddable = true;
-                } else {
-                    something_nonoverriddable = false;
-                    for (const auto &eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
-                        if (!layer_tools.wiping_extrusions().is_obj_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection &>(*eec), object))
-                            something_nonoverriddable = true;
-                }
+                if(ignore_inner_color && layerm->all_inner)
+                    continue;
+                    
+                if (! layerm->perimeters.entities.empty()) {
+                    bool something_nonoverriddable = true;
+
+                    if (m_print_config_ptr) { // in this case print->config().print_sequence != PrintSequence::ByObject (see ToolOrdering constructors)
+                        something_nonoverriddable = false;
+                        for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
+                            if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
+                                something_nonoverriddable = true;
+                    } else {
+                        something_nonoverriddable = false;
+                        for (const auto &eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
+                            if (!layer_tools.wiping_extrusions().is_obj_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection &>(*eec), object))
+                                something_nonoverriddable = true;
+                    }
 
-                if (something_nonoverriddable){
-               		layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().wall_filament.value : extruder_override);
-                    if (layerCount == 0) {
-                        firstLayerExtruders.emplace_back((extruder_override == 0) ? region.config().wall_filament.value : extruder_override);
+                    if (something_nonoverriddable){
+                        layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().wall_filament.value : extruder_override);
+                        if (layer_idx == 0) {
+                            // Only the task processing the first layer writes here.
+                            firstLayerExtruders.emplace_back((extruder_override == 0) ? region.config().wall_filament.value : extruder_override);
+                        }
                     }
-                }
 
-                layer_tools.has_object = true;
-            }
+                    layer_tools.has_object = true;
+                }
 
-            bool has_infill       = false;
-            bool has_solid_infill = false;
-            bool something_nonoverriddable = false;
-            for (const ExtrusionEntity *ee : layerm->fills.entities) {
-                // fill represents infill extrusions of a single island.
-                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
-                if (is_solid_infill(role))
-                    has_solid_infill = true;
-                else if (is_infill(role))
-                    has_infill = true;
-
-                if (m_print_config_ptr) {
-                    if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
-                        something_nonoverriddable = true;
-                } else {
-                    if (!layer_tools.wiping_extrusions().is_obj_overriddable_and_mark(*fill, object))
-                        something_nonoverriddable = true;
+                bool has_infill       = false;
+                bool has_solid_infill = false;
+                bool something_nonoverriddable = false;
+                for (const ExtrusionEntity *ee : layerm->fills.entities) {
+                    // fill represents infill extrusions of a single island.
+                    const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                    ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
+                    if (is_solid_infill(role))
+                        has_solid_infill = true;
+                    else if (is_infill(role))
+                        has_infill = true;
+
+                    if (m_print_config_ptr) {
+                        if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
+                            something_nonoverriddable = true;
+                    } else {
+                        if (!layer_tools.wiping_extrusions().is_obj_overriddable_and_mark(*fill, object))
+                            something_nonoverriddable = true;
+                    }
                 }
-            }
 
-            if (something_nonoverriddable) {
-            	if (extruder_override == 0) {
-		                if (has_solid_infill)
-		                    layer_tools.extruders.emplace_back(region.config().solid_infill_filament);
-		                if (has_infill)
-	                    layer_tools.extruders.emplace_back(region.config().sparse_infill_filament);
-            	} else if (has_solid_infill || has_infill)
-            		layer_tools.extruders.emplace_back(extruder_override);
+                if (something_nonoverriddable) {
+                    if (extruder_override == 0) {
+                        if (has_solid_infill)
+                            layer_tools.extruders.emplace_back(region.config().solid_infill_filament);
+                        if (has_infill)
+                            layer_tools.extruders.emplace_back(region.config().sparse_infill_filament);
+                    } else if (has_solid_infill || has_infill)
+                        layer_tools.extruders.emplace_back(extruder_override);
+                }
+                if (has_solid_infill || has_infill)
+                    layer_tools.has_object = true;
             }
-            if (has_solid_infill || has_infill)
-                layer_tools.has_object = true;
         }
-        layerCount++;
-    }
+    });
 
     sort_remove_duplicates(firstLayerExtruders);
     const_cast<PrintObject&>(object).object_first_layer_wall_extruders = firstLayerExtruders;
@@ -6,6 +6,10 @@
 #include "../Fill/FillRectilinear.hpp"
 #include "../Surface.hpp"
 
+#include <algorithm>
+
+#include <tbb/parallel_for.h>
+
 namespace Slic3r
 {
 
@@ -47,6 +51,101 @@ DilationKernel::DilationKernel(GridPoint3 kernel_size, DilationKernel::Type type
     }
 }
 
+VoxelGrid::VoxelGrid(const GridPoint3& min, const GridPoint3& max)
+    : min_(min)
+    , max_(max)
+    , size_((max - min + GridPoint3(1, 1, 1)).cwiseMax(GridPoint3(0, 0, 0)))
+    , row_words_((size_t(size_.x()) + 63) / 64)
+    , words_(row_words_ * size_t(size_.y()) * size_t(size_.z()), 0)
+{
+}
+
+bool VoxelGrid::empty() const
+{
+    return std::all_of(words_.begin(), words_.end(), [](uint64_t word) { return word == 0; });
+}
+
+VoxelGrid& VoxelGrid::operator|=(const VoxelGrid& rhs)
+{
+    assert(min_ == rhs.min_ && max_ == rhs.max_);
+    for (size_t i = 0; i < words_.size(); ++ i)
+        words_[i] |= rhs.words_[i];
+    return *this;
+}
+
+VoxelGrid& VoxelGrid::operator&=(const VoxelGrid& rhs)
+{
+    assert(min_ == rhs.min_ && max_ == rhs.max_);
+    for (size_t i = 0; i < words_.size(); ++ i)
+        words_[i] &= rhs.words_[i];
+    return *this;
+}
+
+VoxelGrid& VoxelGrid::subtract(const VoxelGrid& rhs)
+{
+    assert(min_ == rhs.min_ && max_ == rhs.max_);
+    for (size_t i = 0; i < words_.size(); ++ i)
+        words_[i] &= ~rhs.words_[i];
+    return *this;
+}
+
+void VoxelGrid::clear_below(coord_t z)
+{
+    if (z <= min_.z() || words_.empty())
+        return;
+    z = std::min(z, max_.z() + 1);
+    std::fill(words_.begin(), words_.begin() + row(min_.y(), z), 0);
+}
+
+// dst |= src shifted by shift bits towards the higher bits. Bits shifted outside of the row are dropped.
+static void or_shifted_row(uint64_t* dst, const uint64_t* src, size_t num_words, coord_t shift)
+{
+    if (shift >= 0) {
+        const size_t q = size_t(shift) / 64;
+        const size_t r = size_t(shift) % 64;
+        for (size_t i = q; i < num_words; ++ i) {
+            uint64_t v = src[i - q] << r;
+            if (r != 0 && i > q)
+                v |= src[i - q - 1] >> (64 - r);
+            dst[i] |= v;
+        }
+    } else {
+        const size_t q = size_t(-shift) / 64;
+        const size_t r = size_t(-shift) % 64;
+        for (size_t i = 0; i + q < num_words; ++ i) {
+            uint64_t v = src[i + q] >> r;
+            if (r != 0 && i + q + 1 < num_words)
+                v |= src[i + q + 1] << (64 - r);
+            dst[i] |= v;
+        }
+    }
+}
+
+VoxelGrid VoxelGrid::dilated(const DilationKernel& kernel) const
+{
+    VoxelGrid out(min_, max_);
+    if (words_.empty())
+        return out;
+    // Bits past the end of a row must stay zero, so that shifting rows to the right doesn't drag them in.
+    const uint64_t last_word_mask = size_.x() % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (size_.x() % 64)) - 1;
+    // Each task only writes the rows of its own z plane.
+    tbb::parallel_for(tbb::blocked_range<coord_t>(0, size_.z()), [this, &out, &kernel, last_word_mask](const tbb::blocked_range<coord_t>& range) {
+        for (coord_t z = range.begin(); z < range.end(); ++ z) {
+            for (const GridPoint3& rel : kernel.relative_cells_) {
+                const coord_t src_z = z - rel.z();
+                if (src_z < 0 || src_z >= size_.z())
+                    continue;
+                for (coord_t y = std::max<coord_t>(0, rel.y()); y < std::min(size_.y(), size_.y() + rel.y()); ++ y)
+                    or_shifted_row(out.words_.data() + out.row(min_.y() + y, min_.z() + z), words_.data() + row(min_.y() + y - rel.y(), min_.z() + src_z),
+                                   row_words_, rel.x());
+            }
+            for (coord_t y = 0; y < size_.y(); ++ y)
+                out.words_[out.row(min_.y() + y, min_.z() + z) + row_words_ - 1] &= last_word_mask;
+        }
+    });
+    return out;
+}
+
 bool VoxelUtils::walkLine(Vec3crd start, Vec3crd end, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     Vec3crd diff = end - start;
@@ -115,6 +214,11 @@ bool VoxelUtils::walkPolygons(const ExPolygon& polys, coord_t z, const std::func
 }
 
 bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkKernelAlignedPolygons(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkKernelAlignedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -126,7 +230,7 @@ bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const Di
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return walkPolygons(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return walkPolygons(translated, z + translation.z(), process_cell_func);
 }
 
 bool VoxelUtils::walkAreas(const ExPolygon& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const
@@ -188,6 +292,11 @@ bool VoxelUtils::_walkAreas(const ExPolygon& polys, coord_t z, const std::functi
 }
 
 bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkKernelAlignedAreas(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkKernelAlignedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -200,7 +309,7 @@ bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const Dilat
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return _walkAreas(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return _walkAreas(translated, z + translation.z(), process_cell_func);
 }
 
 std::function<bool(GridPoint3)> VoxelUtils::dilate(const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
@@ -4,7 +4,9 @@
 #ifndef UTILS_VOXEL_UTILS_H
 #define UTILS_VOXEL_UTILS_H
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 #include "../Polygon.hpp"
 #include "../ExPolygon.hpp"
@@ -54,6 +56,92 @@ struct DilationKernel
     DilationKernel(GridPoint3 kernel_size, Type type);
 };
 
+/*!
+ * Dense bitset over a box of voxel cells, one bit per cell.
+ *
+ * Each row of cells along x is stored as a run of 64 bit words, so that union, intersection, difference and dilation
+ * handle 64 cells per operation instead of hashing every cell separately.
+ * Grids combined with each other must have been created with the same bounds.
+ */
+class VoxelGrid
+{
+public:
+    VoxelGrid() = default;
+
+    /*!
+     * \param min The lowest cell of the grid
+     * \param max The highest cell of the grid (inclusive)
+     */
+    VoxelGrid(const GridPoint3& min, const GridPoint3& max);
+
+    const GridPoint3& min() const { return min_; }
+    const GridPoint3& max() const { return max_; }
+
+    bool contains(const GridPoint3& p) const
+    {
+        return p.x() >= min_.x() && p.y() >= min_.y() && p.z() >= min_.z() && p.x() <= max_.x() && p.y() <= max_.y() && p.z() <= max_.z();
+    }
+
+    void set(const GridPoint3& p)
+    {
+        assert(contains(p));
+        if (contains(p)) {
+            const size_t x = size_t(p.x() - min_.x());
+            words_[row(p.y(), p.z()) + x / 64] |= uint64_t(1) << (x % 64);
+        }
+    }
+
+    bool test(const GridPoint3& p) const
+    {
+        if (! contains(p))
+            return false;
+        const size_t x = size_t(p.x() - min_.x());
+        return (words_[row(p.y(), p.z()) + x / 64] >> (x % 64)) & 1;
+    }
+
+    bool empty() const;
+
+    VoxelGrid& operator|=(const VoxelGrid& rhs);
+    VoxelGrid& operator&=(const VoxelGrid& rhs);
+    //! Remove all cells which are set in \p rhs.
+    VoxelGrid& subtract(const VoxelGrid& rhs);
+
+    //! Remove all cells below height \p z.
+    void clear_below(coord_t z);
+
+    /*!
+     * Dilate with a kernel: the result contains each cell of this grid offset by each of the relative cells of the \p kernel.
+     * Cells which would end up outside of the bounds of the grid are dropped.
+     */
+    VoxelGrid dilated(const DilationKernel& kernel) const;
+
+    /*!
+     * Call \p process_cell_func on each set cell, ordered by z, then y, then x.
+     */
+    template<typename ProcessCellFunc>
+    void for_each(ProcessCellFunc&& process_cell_func) const
+    {
+        for (coord_t z = 0; z < size_.z(); ++ z)
+            for (coord_t y = 0; y < size_.y(); ++ y) {
+                const uint64_t* row_words = words_.data() + row(y + min_.y(), z + min_.z());
+                for (size_t w = 0; w < row_words_; ++ w)
+                    for (uint64_t word = row_words[w], x = w * 64; word != 0; word >>= 1, ++ x)
+                        if (word & 1)
+                            process_cell_func(GridPoint3(min_.x() + coord_t(x), min_.y() + y, min_.z() + z));
+            }
+    }
+
+private:
+    //! Index of the first word of the row of cells at (\p y, \p z).
+    size_t row(coord_t y, coord_t z) const { return (size_t(z - min_.z()) * size_t(size_.y()) + size_t(y - min_.y())) * row_words_; }
+
+    GridPoint3            min_ { 0, 0, 0 };
+    GridPoint3            max_ { -1, -1, -1 };
+    GridPoint3            size_ { 0, 0, 0 }; //!< Number of cells in each dimension
+    size_t                row_words_ { 0 }; //!< Number of words per row of cells along x
+    std::vector<uint64_t> words_;
+};
+
 /*!
  * Utility class for walking over a 3D voxel grid.
  *
@@ -105,6 +193,22 @@ public:
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
     bool walkDilatedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+
+    /*!
+     * Process the voxels which walkDilatedPolygons would dilate, without dilating them.
+     * Dilating the processed cells by the \p kernel afterwards, for example with VoxelGrid::dilated, gives the same cells as walkDilatedPolygons.
+     */
+    bool walkKernelAlignedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    bool walkKernelAlignedPolygons(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+    {
+        for (const auto & poly : polys) {
+            if (!walkKernelAlignedPolygons(poly, z, kernel, process_cell_func)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
     bool walkDilatedPolygons(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
     {
         for (const auto & poly : polys) {
@@ -147,6 +251,21 @@ public:
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
     bool walkDilatedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+
+    /*!
+     * Process the voxels which walkDilatedAreas would dilate, without dilating them.
+     */
+    bool walkKernelAlignedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    bool walkKernelAlignedAreas(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+    {
+        for (const auto & poly : polys) {
+            if (!walkKernelAlignedAreas(poly, z, kernel, process_cell_func)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
     bool walkDilatedAreas(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
     {
         for (const auto & poly : polys) {
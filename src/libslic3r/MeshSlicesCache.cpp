@@ -0,0 +1,139 @@
+#include "MeshSlicesCache.hpp"
+
+#include <algorithm>
+
+namespace Slic3r {
+
+// Compares all fields of MeshSlicingParams and MeshSlicingParamsEx, a field added there has to be compared here as well.
+// miny is left uninitialized unless slicing for a belt printer.
+static bool slicing_params_equal(const MeshSlicingParamsEx &l, const MeshSlicingParamsEx &r)
+{
+    return l.mode == r.mode && l.slicing_mode_normal_below_layer == r.slicing_mode_normal_below_layer && l.mode_below == r.mode_below &&
+           l.trafo.matrix() == r.trafo.matrix() && l.is_belt == r.is_belt && (! l.is_belt || l.miny == r.miny) &&
+           l.closing_radius == r.closing_radius && l.extra_offset == r.extra_offset && l.resolution == r.resolution;
+}
+
+static size_t slices_memsize(const std::vector<ExPolygons> &slices)
+{
+    size_t memsize = slices.capacity() * sizeof(ExPolygons);
+    for (const ExPolygons &expolys : slices) {
+        memsize += expolys.capacity() * sizeof(ExPolygon);
+        for (const ExPolygon &expoly : expolys) {
+            memsize += expoly.contour.points.capacity() * sizeof(Point) + expoly.holes.capacity() * sizeof(Polygon);
+            for (const Polygon &hole : expoly.holes)
+                memsize += hole.points.capacity() * sizeof(Point);
+        }
+    }
+    return memsize;
+}
+
+MeshSlicesCache& MeshSlicesCache::instance()
+{
+    static MeshSlicesCache cache;
+    return cache;
+}
+
+bool MeshSlicesCache::find(const std::shared_ptr<const TriangleMesh> &mesh, const std::vector<float> &zs, const MeshSlicingParamsEx &params, std::vector<ExPolygons> &slices)
+{
+    assert(mesh);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto range = m_entries.equal_range(mesh.get());
+    for (auto it = range.first; it != range.second; ++ it) {
+        Entry &entry = it->second;
+        // The address of a destroyed mesh may be reused by a new one.
+        if (! entry.context && entry.mesh.lock() == mesh && entry.zs == zs && slicing_params_equal(entry.params, params)) {
+            entry.last_used = ++ m_time;
+            slices = entry.slices;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshSlicesCache::store(const std::shared_ptr<const TriangleMesh> &mesh, const std::vector<float> &zs, const MeshSlicingParamsEx &params, const std::vector<ExPolygons> &slices)
+{
+    assert(mesh);
+    Entry entry;
+    entry.mesh      = mesh;
+    entry.zs        = zs;
+    entry.params    = params;
+    entry.slices    = slices;
+    entry.memsize   = slices_memsize(slices) + zs.capacity() * sizeof(float);
+    this->insert(mesh.get(), std::move(entry));
+}
+
+std::shared_ptr<const MeshSlicingContext> MeshSlicesCache::find_context(const std::shared_ptr<const TriangleMesh> &mesh, const Transform3d &trafo)
+{
+    assert(mesh);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto range = m_entries.equal_range(mesh.get());
+    for (auto it = range.first; it != range.second; ++ it) {
+        Entry &entry = it->second;
+        if (entry.context && entry.mesh.lock() == mesh && entry.params.trafo.matrix() == trafo.matrix()) {
+            entry.last_used = ++ m_time;
+            return entry.context;
+        }
+    }
+    return nullptr;
+}
+
+void MeshSlicesCache::store_context(const std::shared_ptr<const TriangleMesh> &mesh, const Transform3d &trafo, std::shared_ptr<const MeshSlicingContext> context)
+{
+    assert(mesh && context);
+    Entry entry;
+    entry.mesh         = mesh;
+    entry.params.trafo = trafo;
+    entry.memsize      = context->memsize();
+    entry.context      = std::move(context);
+    this->insert(mesh.get(), std::move(entry));
+}
+
+void MeshSlicesCache::insert(const TriangleMesh *key, Entry &&entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (entry.memsize > m_memory_limit / 4)
+        // Don't let a single huge object flush the cache.
+        return;
+    entry.last_used = ++ m_time;
+    m_memsize += entry.memsize;
+    m_entries.emplace(key, std::move(entry));
+    purge();
+}
+
+void MeshSlicesCache::set_memory_limit(size_t limit)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memory_limit = limit;
+    purge();
+}
+
+size_t MeshSlicesCache::memsize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memsize;
+}
+
+void MeshSlicesCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_memsize = 0;
+}
+
+void MeshSlicesCache::purge()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+        if (it->second.mesh.expired()) {
+            m_memsize -= it->second.memsize;
+            it = m_entries.erase(it);
+        } else
+            ++ it;
+    while (m_memsize > m_memory_limit && ! m_entries.empty()) {
+        auto it_lru = std::min_element(m_entries.begin(), m_entries.end(),
+            [](const auto &l, const auto &r) { return l.second.last_used < r.second.last_used; });
+        m_memsize -= it_lru->second.memsize;
+        m_entries.erase(it_lru);
+    }
+}
+
+} // namespace Slic3r
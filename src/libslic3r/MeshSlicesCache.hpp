@@ -0,0 +1,68 @@
+#ifndef slic3r_MeshSlicesCache_hpp_
+#define slic3r_MeshSlicesCache_hpp_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ExPolygon.hpp"
+#include "TriangleMesh.hpp"
+#include "TriangleMeshSlicer.hpp"
+
+namespace Slic3r {
+
+// Process wide cache of the slices of shared immutable meshes, for example ModelVolume::mesh_ptr().
+// Each plate is sliced by its own Print, thus an object placed on multiple plates, or its copies sharing the mesh,
+// would be sliced again by each Print. The slices only depend on the mesh, on the slicing planes and on the slicing
+// parameters including the transformation, which does not contain the position of the instance on the bed.
+// The slices are copied in and out of the cache, thus the cache does not share any state between the Prints.
+// The cache also keeps the MeshSlicingContext of a mesh per transformation, so that slicing the same mesh at other zs
+// does not transform the vertices, calculate the edge IDs and sort the facets again.
+// The least recently used slices and contexts are dropped once the cache grows over its memory limit.
+class MeshSlicesCache
+{
+public:
+    static MeshSlicesCache& instance();
+
+    // Fills in slices and returns true if the mesh has been sliced with the same zs and params before. Thread safe.
+    bool find(const std::shared_ptr<const TriangleMesh> &mesh, const std::vector<float> &zs, const MeshSlicingParamsEx &params, std::vector<ExPolygons> &slices);
+    // Stores a copy of the slices of mesh. Thread safe.
+    void store(const std::shared_ptr<const TriangleMesh> &mesh, const std::vector<float> &zs, const MeshSlicingParamsEx &params, const std::vector<ExPolygons> &slices);
+    // Returns the slicing context of the mesh transformed by trafo if it has been stored before, nullptr otherwise. Thread safe.
+    std::shared_ptr<const MeshSlicingContext> find_context(const std::shared_ptr<const TriangleMesh> &mesh, const Transform3d &trafo);
+    // Stores the slicing context of the mesh transformed by trafo. Thread safe.
+    void store_context(const std::shared_ptr<const TriangleMesh> &mesh, const Transform3d &trafo, std::shared_ptr<const MeshSlicingContext> context);
+
+    void   set_memory_limit(size_t limit);
+    size_t memsize() const;
+    void   clear();
+
+private:
+    MeshSlicesCache() = default;
+
+    // Either slices for zs and params, or a context for params.trafo.
+    struct Entry {
+        std::weak_ptr<const TriangleMesh>           mesh;
+        std::vector<float>                          zs;
+        MeshSlicingParamsEx                         params;
+        std::vector<ExPolygons>                     slices;
+        std::shared_ptr<const MeshSlicingContext>   context;
+        size_t                                      memsize { 0 };
+        size_t                                      last_used { 0 };
+    };
+
+    void insert(const TriangleMesh *key, Entry &&entry);
+    // Drop the entries of destroyed meshes, then the least recently used ones over the memory limit. Called with m_mutex locked.
+    void purge();
+
+    mutable std::mutex                                     m_mutex;
+    std::unordered_multimap<const TriangleMesh*, Entry>    m_entries;
+    size_t                                                 m_memsize { 0 };
+    size_t                                                 m_memory_limit { 256 * 1024 * 1024 };
+    size_t                                                 m_time { 0 };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_MeshSlicesCache_hpp_
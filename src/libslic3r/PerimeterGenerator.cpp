@@ -1788,10 +1788,9 @@ void PerimeterGenerator::apply_extra_perimeters(ExPolygons &infill_area)
 
             SurfaceCollection orig_surfaces = *this->fill_surfaces;
             this->fill_surfaces->clear();
-            for (const auto &surface : orig_surfaces.surfaces) {
-                auto new_surfaces = diff_ex({surface.expolygon}, filled_area);
-                this->fill_surfaces->append(new_surfaces, surface);
-            }
+            std::vector<ExPolygons> new_surfaces = diff_ex_batch(orig_surfaces.surfaces, filled_area);
+            for (size_t i = 0; i < orig_surfaces.surfaces.size(); ++ i)
+                this->fill_surfaces->append(std::move(new_surfaces[i]), orig_surfaces.surfaces[i]);
         }
     }
 }
@@ -52,7 +52,10 @@
 #include <boost/phoenix/bind/bind_function.hpp>
 
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 // #define USE_CPP11_REGEX
 #ifdef USE_CPP11_REGEX
@@ -1015,6 +1018,40 @@ namespace client
         template <typename It, typename Attr> static bool parse_inf(It&, It const&, Attr&) { return false; }
     };
 
+    // Skip a single UTF-8 character. Returns false if an invalid UTF-8 sequence is encountered.
+    template <typename Iterator>
+    static bool utf8_skip_char(Iterator &it, const Iterator &last)
+    {
+        // Read the first byte of the UTF-8 sequence.
+        unsigned char   c  = static_cast<boost::uint8_t>(*it ++);
+        unsigned int    cnt = 0;
+        // UTF-8 sequence must not start with a continuation character:
+        if ((c & 0xC0) == 0x80)
+            return false;
+        // Skip high surrogate first if there is one.
+        // If the most significant bit with a zero in it is in position
+        // 8-N then there are N bytes in this UTF-8 sequence:
+        {
+            unsigned char mask   = 0x80u;
+            unsigned int  result = 0;
+            while (c & mask) {
+                ++ result;
+                mask >>= 1;
+            }
+            cnt = (result == 0) ? 1 : ((result > 4) ? 4 : result);
+        }
+        // Since we haven't read in a value, we need to validate the code points:
+        for (-- cnt; cnt > 0; -- cnt) {
+            if (it == last)
+                return false;
+            c = static_cast<boost::uint8_t>(*it ++);
+            // We must have a continuation byte:
+            if (cnt > 1 && (c & 0xC0) != 0x80)
+                return false;
+        }
+        return true;
+    }
+
     // This parser is to be used inside a raw[] directive to accept a single valid UTF-8 character.
     // If an invalid UTF-8 sequence is encountered, a qi::expectation_failure is thrown.
     struct utf8_char_skipper_parser : qi::primitive_parser<utf8_char_skipper_parser>
@@ -1035,39 +1072,13 @@ namespace client
             if (first == last)
                 return false;
             // Iterator over the UTF-8 sequence.
-            auto            it = first;
-            // Read the first byte of the UTF-8 sequence.
-            unsigned char   c  = static_cast<boost::uint8_t>(*it ++);
-            unsigned int    cnt = 0;
-            // UTF-8 sequence must not start with a continuation character:
-            if ((c & 0xC0) == 0x80)
-                goto err;
-            // Skip high surrogate first if there is one.
-            // If the most significant bit with a zero in it is in position
-            // 8-N then there are N bytes in this UTF-8 sequence:
-            {
-                unsigned char mask   = 0x80u;
-                unsigned int  result = 0;
-                while (c & mask) {
-                    ++ result;
-                    mask >>= 1;
-                }
-                cnt = (result == 0) ? 1 : ((result > 4) ? 4 : result);
-            }
-            // Since we haven't read in a value, we need to validate the code points:
-            for (-- cnt; cnt > 0; -- cnt) {
-                if (it == last)
-                    goto err;
-                c = static_cast<boost::uint8_t>(*it ++);
-                // We must have a continuation byte:
-                if (cnt > 1 && (c & 0xC0) != 0x80)
-                    goto err;
+            auto it = first;
+            if (! utf8_skip_char(it, last)) {
+                MyContext::throw_exception("Invalid utf8 sequence", boost::iterator_range<Iterator>(first, last));
+                return false;
             }
             first = it;
             return true;
-        err:
-            MyContext::throw_exception("Invalid utf8 sequence", boost::iterator_range<Iterator>(first, last));
-            return false;
         }
 
         // This function is called during error handling to create a human readable string for the error context.
@@ -1430,6 +1441,146 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     return output;
 }
 
+// Template split at its top level into literal text to be copied verbatim and into self-contained
+// macros ({expression}, {if}...{endif} blocks, [legacy_variable]) to be processed by the macro_processor grammar.
+// The literal text does not need to be parsed by the grammar again, thus custom G-code blocks consisting mostly
+// of plain G-code with a couple of variable expansions are cheap to process once compiled.
+struct CompiledTemplate
+{
+    struct Segment {
+        bool        literal;
+        std::string text;
+    };
+    std::vector<Segment> segments;
+};
+
+// Skip a legacy variable expansion "[identifier]" or "[identifier[identifier]]", return the position after the closing ']'.
+// Returns std::string::npos if the extent of the expansion could not be reliably determined.
+static size_t skip_legacy_variable_expansion(const std::string &templ, size_t i)
+{
+    assert(templ[i] == '[');
+    int depth = 0;
+    for (; i < templ.size(); ++ i) {
+        char c = templ[i];
+        if (c == '[')
+            ++ depth;
+        else if (c == ']') {
+            if (-- depth == 0)
+                return i + 1;
+        } else if (! (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == ' ' || c == '\t'))
+            break;
+    }
+    return std::string::npos;
+}
+
+// Skip a macro enclosed in {}, return the position after the closing '}'. String literals and regular expressions
+// may contain the closing brace. The first identifier of the macro is returned through first_word.
+// Returns std::string::npos if the extent of the macro could not be reliably determined.
+static size_t skip_macro(const std::string &templ, size_t i, std::string &first_word)
+{
+    assert(templ[i] == '{');
+    auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; };
+    // Skip a string literal or a regular expression starting with the delimiter at i, return the position after the closing delimiter.
+    auto skip_quoted = [&templ](size_t i) -> size_t {
+        char delimiter = templ[i ++];
+        for (; i < templ.size(); ++ i)
+            if (templ[i] == '\\')
+                ++ i;
+            else if (templ[i] == delimiter)
+                return i + 1;
+        return std::string::npos;
+    };
+    for (++ i; i < templ.size() && is_space(templ[i]); ++ i) ;
+    size_t word_begin = i;
+    for (; i < templ.size() && (std::isalnum(static_cast<unsigned char>(templ[i])) || templ[i] == '_'); ++ i) ;
+    first_word = templ.substr(word_begin, i - word_begin);
+    while (i < templ.size()) {
+        char c = templ[i];
+        if (c == '}')
+            return i + 1;
+        if (c == '{')
+            return std::string::npos;
+        if (c == '"') {
+            i = skip_quoted(i);
+            if (i == std::string::npos)
+                return i;
+        } else if ((c == '=' || c == '!') && i + 1 < templ.size() && templ[i + 1] == '~') {
+            // Regular expression match operator is followed by a regular expression enclosed in //.
+            for (i += 2; i < templ.size() && is_space(templ[i]); ++ i) ;
+            if (i == templ.size() || templ[i] != '/')
+                return std::string::npos;
+            i = skip_quoted(i);
+            if (i == std::string::npos)
+                return i;
+        } else
+            ++ i;
+    }
+    return std::string::npos;
+}
+
+// Split the template into segments. Returns nullptr if the template could not be reliably split,
+// in that case the template is processed as a whole. Invalid templates are never split, so that
+// the error messages refer to the complete template.
+static std::shared_ptr<const CompiledTemplate> compile_template(const std::string &templ)
+{
+    auto out = std::make_shared<CompiledTemplate>();
+    size_t i = 0;
+    while (i < templ.size()) {
+        size_t begin = i;
+        char   c     = templ[i];
+        if (c != '[' && c != '{') {
+            // Free-form text up to a first brace.
+            auto it = templ.begin() + i;
+            while (it != templ.end() && *it != '[' && *it != '{')
+                if (! client::utf8_skip_char(it, templ.end()))
+                    return nullptr;
+            i = it - templ.begin();
+            // The grammar skips leading white space of the whole template, let the grammar process such a text.
+            bool literal = begin > 0 || ! (std::isspace(static_cast<unsigned char>(c)) || static_cast<unsigned char>(c) >= 0x80);
+            out->segments.push_back({ literal, templ.substr(begin, i - begin) });
+            continue;
+        }
+        // Macro, legacy variable expansion or a complete {if}...{endif} block.
+        int depth = 0;
+        do {
+            if (templ[i] == '[') {
+                i = skip_legacy_variable_expansion(templ, i);
+            } else if (templ[i] == '{') {
+                std::string first_word;
+                i = skip_macro(templ, i, first_word);
+                if (first_word == "if")
+                    ++ depth;
+                else if (first_word == "endif")
+                    -- depth;
+                else if (depth == 0 && (first_word == "elsif" || first_word == "else"))
+                    return nullptr;
+            } else
+                // Free-form text inside an {if} block, '}' is a valid character here.
+                for (; i < templ.size() && templ[i] != '[' && templ[i] != '{'; ++ i) ;
+            if (i == std::string::npos || depth < 0)
+                return nullptr;
+        } while (depth > 0 && i < templ.size());
+        if (depth > 0)
+            return nullptr;
+        out->segments.push_back({ false, templ.substr(begin, i - begin) });
+    }
+    return out;
+}
+
+// Compiled templates are cached by the template text, the same custom G-code blocks are processed at each layer and tool change.
+static std::shared_ptr<const CompiledTemplate> compiled_template(const std::string &templ)
+{
+    static std::mutex                                                               mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const CompiledTemplate>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto it = cache.find(templ); it != cache.end())
+        return it->second;
+    if (cache.size() >= 1024)
+        // Don't let the cache grow indefinitely.
+        cache.clear();
+    return cache.emplace(templ, compile_template(templ)).first->second;
+}
+
 std::string PlaceholderParser::process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context_data) const
 {
     client::MyContext context;
@@ -1439,7 +1590,24 @@ std::string PlaceholderParser::process(const std::string &templ, unsigned int cu
     context.config_outputs      = config_outputs;
     context.current_extruder_id = current_extruder_id;
     context.context_data        = context_data;
-    return process_macro(templ, context);
+
+    std::shared_ptr<const CompiledTemplate> compiled = compiled_template(templ);
+    if (! compiled || compiled->segments.size() < 2)
+        return process_macro(templ, context);
+
+    std::string output;
+    try {
+        for (const CompiledTemplate::Segment &segment : compiled->segments)
+            if (segment.literal)
+                output += segment.text;
+            else
+                output += process_macro(segment.text, context);
+    } catch (...) {
+        // Process the whole template again to report the error in the context of the complete template.
+        context.error_message.clear();
+        return process_macro(templ, context);
+    }
+    return output;
 }
 
 // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
@@ -10,7 +10,7 @@
 #include "Geometry/ConvexHull.hpp"
 #include "I18N.hpp"
 #include "ShortestPath.hpp"
-#include "Support/SupportMaterial.hpp"
+#include "support_new/SupportMaterial.hpp"
 #include "Thread.hpp"
 #include "Time.hpp"
 #include "GCode.hpp"
@@ -91,6 +91,7 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    m_wipe_tower_plan_cache.clear();
 }
 
 // Called by Print::apply().
@@ -2108,6 +2109,8 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
 
     BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": total object counts %1% in current print, need to slice %2%")%m_objects.size()%need_slicing_objects.size();
     BOOST_LOG_TRIVIAL(error) << "Starting the slicing process." << log_memory_info();
+    m_print_statistics.sliced_volumes        = 0;
+    m_print_statistics.sliced_volumes_cached = 0;
 
     if (!use_cache) {
         for (PrintObject *obj : m_objects) {
@@ -2218,6 +2221,11 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
     }
 
     if (this->set_started(psWipeTower)) {
+        // Keep the results of the last wipe tower generation, _make_wipe_tower() reuses them if the tool changes are planned the same way.
+        if (this->has_wipe_tower())
+            m_wipe_tower_plan_cache.stash(m_wipe_tower_data);
+        else
+            m_wipe_tower_plan_cache.clear();
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
         if (this->has_wipe_tower()) {
@@ -2319,6 +2327,9 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
             *time_cost_with_cache = *time_cost_with_cache + end_time - start_time;
         }
     }
+    if (m_print_statistics.sliced_volumes > 0)
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": sliced %1% volumes, %2% of them reused from the mesh slices cache")
+            % m_print_statistics.sliced_volumes % m_print_statistics.sliced_volumes_cached;
     //BBS
     for (PrintObject *obj : m_objects) {
         if (((!use_cache)&&(need_slicing_objects.count(obj) != 0))
@@ -2895,6 +2906,82 @@ bool Print::enable_timelapse_print() const
     return m_config.timelapse_type.value == TimelapseType::tlSmooth;
 }
 
+bool WipeTowerPlan::operator==(const WipeTowerPlan &rhs) const
+{
+    return generator == rhs.generator && plate_index == rhs.plate_index && origin == rhs.origin &&
+           first_extruder == rhs.first_extruder && all_extruders == rhs.all_extruders &&
+           last_print_z == rhs.last_print_z && last_partitions == rhs.last_partitions &&
+           object_layer_height == rhs.object_layer_height && first_layer_height == rhs.first_layer_height &&
+           tool_changes == rhs.tool_changes && no_extruder_fill_layers == rhs.no_extruder_fill_layers &&
+           // Compare the configurations last, they are the most expensive to compare.
+           config.equals(rhs.config) && region_config.equals(rhs.region_config);
+}
+
+void WipeTowerPlanCache::store(WipeTowerPlan &&plan, const WipeTowerData &data, const FakeWipeTower &fake_wipe_tower)
+{
+    this->clear();
+    m_plan                  = std::move(plan);
+    m_used_filament         = data.used_filament;
+    m_number_of_toolchanges = data.number_of_toolchanges;
+    m_depth                 = data.depth;
+    m_z_and_depth_pairs     = data.z_and_depth_pairs;
+    m_brim_width            = data.brim_width;
+    m_height                = data.height;
+    m_bbx                   = data.bbx;
+    m_stable_cone           = data.stable_cone;
+    m_fake_wipe_tower       = fake_wipe_tower;
+    m_valid                 = true;
+}
+
+void WipeTowerPlanCache::stash(WipeTowerData &data)
+{
+    if (! m_valid || m_stashed)
+        return;
+    m_priming              = std::move(data.priming);
+    m_tool_changes         = std::move(data.tool_changes);
+    m_final_purge          = std::move(data.final_purge);
+    m_wipe_tower_mesh_data = std::move(data.wipe_tower_mesh_data);
+    data.tool_changes.clear();
+    data.wipe_tower_mesh_data.reset();
+    m_stashed              = true;
+}
+
+bool WipeTowerPlanCache::restore(const WipeTowerPlan &plan, WipeTowerData &data, FakeWipeTower &fake_wipe_tower)
+{
+    if (! m_valid || ! m_stashed || ! (m_plan == plan)) {
+        this->clear();
+        return false;
+    }
+    data.priming               = std::move(m_priming);
+    data.tool_changes          = std::move(m_tool_changes);
+    data.final_purge           = std::move(m_final_purge);
+    data.wipe_tower_mesh_data  = std::move(m_wipe_tower_mesh_data);
+    data.used_filament         = m_used_filament;
+    data.number_of_toolchanges = m_number_of_toolchanges;
+    data.depth                 = m_depth;
+    data.z_and_depth_pairs     = m_z_and_depth_pairs;
+    data.brim_width            = m_brim_width;
+    data.height                = m_height;
+    data.bbx                   = m_bbx;
+    data.stable_cone           = m_stable_cone;
+    fake_wipe_tower            = m_fake_wipe_tower;
+    m_tool_changes.clear();
+    m_wipe_tower_mesh_data.reset();
+    m_stashed                  = false;
+    return true;
+}
+
+void WipeTowerPlanCache::clear()
+{
+    m_valid   = false;
+    m_stashed = false;
+    m_plan    = WipeTowerPlan();
+    m_priming.reset();
+    m_tool_changes.clear();
+    m_final_purge.reset();
+    m_wipe_tower_mesh_data.reset();
+}
+
 void Print::_make_wipe_tower()
 {
     m_wipe_tower_data.clear();
@@ -2926,9 +3013,11 @@ void Print::_make_wipe_tower()
     // BBS: priming logic is removed, so don't consider it in tool ordering
     m_wipe_tower_data.tool_ordering = ToolOrdering(*this, (unsigned int) -1, bUseWipeTower2 ? true : false);
 
-    if (!m_wipe_tower_data.tool_ordering.has_wipe_tower())
+    if (!m_wipe_tower_data.tool_ordering.has_wipe_tower()) {
         // Don't generate any wipe tower.
+        m_wipe_tower_plan_cache.clear();
         return;
+    }
 
     // Check whether there are any layers in m_tool_ordering, which are marked with has_wipe_tower,
     // they print neither object, nor support. These layers are above the raft and below the object, and they
@@ -2967,7 +3056,21 @@ void Print::_make_wipe_tower()
     }
     this->throw_if_canceled();
 
+    // Inputs of the wipe tower generation besides the tool changes, which are recorded while planning them.
+    WipeTowerPlan plan;
+    plan.config              = m_config;
+    plan.region_config       = m_default_region_config;
+    plan.plate_index         = m_plate_index;
+    plan.origin              = m_origin;
+    plan.first_extruder      = m_wipe_tower_data.tool_ordering.first_extruder();
+    plan.all_extruders       = m_wipe_tower_data.tool_ordering.all_extruders();
+    plan.last_print_z        = m_wipe_tower_data.tool_ordering.back().print_z;
+    plan.last_partitions     = m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions;
+    plan.object_layer_height = m_objects.front()->config().layer_height.value;
+    plan.first_layer_height  = this->skirt_first_layer_height();
+
     if (!bUseWipeTower2) {
+        plan.generator = WipeTowerPlan::Generator::WipeTower;
         // in BBL machine, wipe tower is only use to prime extruder. So just use a global wipe volume.
         WipeTower wipe_tower(m_config, m_plate_index, m_origin, m_config.prime_volume, m_wipe_tower_data.tool_ordering.first_extruder(),
                              m_wipe_tower_data.tool_ordering.empty() ? 0.f : m_wipe_tower_data.tool_ordering.back().print_z);
@@ -2994,6 +3097,7 @@ void Print::_make_wipe_tower()
                 bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
                 wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height, current_extruder_id,
                                            current_extruder_id);
+                plan.add_tool_change(layer_tools, current_extruder_id, current_extruder_id);
 
                 for (const auto extruder_id : layer_tools.extruders) {
                     // BBS: priming logic is removed, so no need to do toolchange for first extruder
@@ -3016,6 +3120,7 @@ void Print::_make_wipe_tower()
                         wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
                                                    current_extruder_id, extruder_id, std::max<float>(m_config.prime_volume,m_config.filament_minimal_purge_on_wipe_tower.get_at(current_extruder_id)),
                                                    volume_to_purge);
+                        plan.add_tool_change(layer_tools, current_extruder_id, extruder_id, volume_to_purge);
                         current_extruder_id = extruder_id;
                     }
                 }
@@ -3023,8 +3128,10 @@ void Print::_make_wipe_tower()
 
                 // if enable timelapse, slice all layer
                 if (enable_timelapse_print()) {
-                    if (layer_tools.wipe_tower_partitions == 0)
+                    if (layer_tools.wipe_tower_partitions == 0) {
                         wipe_tower.set_last_layer_extruder_fill(false);
+                        plan.no_extruder_fill_layers.emplace_back(float(layer_tools.print_z));
+                    }
                     continue;
                 }
 
@@ -3033,6 +3140,10 @@ void Print::_make_wipe_tower()
             }
         }
 
+        if (m_wipe_tower_plan_cache.restore(plan, m_wipe_tower_data, m_fake_wipe_tower))
+            // The tool changes were planned the same way as the last time, reuse the wipe tower generated then.
+            return;
+
         // Generate the wipe tower layers.
         m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
         wipe_tower.generate(m_wipe_tower_data.tool_changes);
@@ -3073,6 +3184,7 @@ void Print::_make_wipe_tower()
             // Initialize the wipe tower.
             WipeTowerCrealityCFS wipe_tower(m_config, m_default_region_config, m_plate_index, m_origin, wipe_volumes,
                                             m_wipe_tower_data.tool_ordering.first_extruder());
+            plan.generator = WipeTowerPlan::Generator::WipeTowerCrealityCFS;
 
             // Set the extruder & material properties at the wipe tower object.
             for (size_t i = 0; i < number_of_extruders; ++i)
@@ -3088,6 +3200,7 @@ void Print::_make_wipe_tower()
                     bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
                     wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
                                                current_extruder_id, current_extruder_id, false);
+                    plan.add_tool_change(layer_tools, current_extruder_id, current_extruder_id);
                     for (const auto extruder_id : layer_tools.extruders) {
                         if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) ||
                             extruder_id != current_extruder_id) {
@@ -3118,14 +3231,17 @@ void Print::_make_wipe_tower()
 
                             wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
                                                        current_extruder_id, extruder_id, volume_to_wipe, purge_volume);
+                            plan.add_tool_change(layer_tools, current_extruder_id, extruder_id, volume_to_wipe, purge_volume);
                             current_extruder_id = extruder_id;
                         }
                     }
                     layer_tools.wiping_extrusions().ensure_perimeters_infills_order(*this);
                     // if enable timelapse, slice all layer
                     if (enable_timelapse_print()) {
-                        if (layer_tools.wipe_tower_partitions == 0)
+                        if (layer_tools.wipe_tower_partitions == 0) {
                             wipe_tower.set_last_layer_extruder_fill(false);
+                            plan.no_extruder_fill_layers.emplace_back(float(layer_tools.print_z));
+                        }
                         continue;
                     }
                     if (&layer_tools == &m_wipe_tower_data.tool_ordering.back() || (&layer_tools + 1)->wipe_tower_partitions == 0)
@@ -3133,6 +3249,10 @@ void Print::_make_wipe_tower()
                 }
             }
 
+            if (m_wipe_tower_plan_cache.restore(plan, m_wipe_tower_data, m_fake_wipe_tower))
+                // The tool changes were planned the same way as the last time, reuse the wipe tower generated then.
+                return;
+
             // Generate the wipe tower layers.
             m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
             wipe_tower.generate(m_wipe_tower_data.tool_changes);
@@ -3178,6 +3298,7 @@ void Print::_make_wipe_tower()
             // Initialize the wipe tower.
             WipeTowerCreality wipe_tower(m_config, m_default_region_config, m_plate_index, m_origin, wipe_volumes,
                                             m_wipe_tower_data.tool_ordering.first_extruder());
+            plan.generator = WipeTowerPlan::Generator::WipeTowerCreality;
 
             // Set the extruder & material properties at the wipe tower object.
             for (size_t i = 0; i < number_of_extruders; ++i)
@@ -3193,6 +3314,7 @@ void Print::_make_wipe_tower()
                     bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
                     wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
                                                 current_extruder_id, current_extruder_id /*, false*/);
+                    plan.add_tool_change(layer_tools, current_extruder_id, current_extruder_id);
                     for (const auto extruder_id : layer_tools.extruders) {
                         if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) ||
                             extruder_id != current_extruder_id) {
@@ -3223,14 +3345,17 @@ void Print::_make_wipe_tower()
 
                             wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
                                                         current_extruder_id, extruder_id, volume_to_wipe, purge_volume);
+                            plan.add_tool_change(layer_tools, current_extruder_id, extruder_id, volume_to_wipe, purge_volume);
                             current_extruder_id = extruder_id;
                         }
                     }
                     layer_tools.wiping_extrusions().ensure_perimeters_infills_order(*this);
                     // if enable timelapse, slice all layer
                     if (enable_timelapse_print()) {
-                        if (layer_tools.wipe_tower_partitions == 0)
+                        if (layer_tools.wipe_tower_partitions == 0) {
                             wipe_tower.set_last_layer_extruder_fill(false);
+                            plan.no_extruder_fill_layers.emplace_back(float(layer_tools.print_z));
+                        }
                         continue;
                     }
                     if (&layer_tools == &m_wipe_tower_data.tool_ordering.back() || (&layer_tools + 1)->wipe_tower_partitions == 0)
@@ -3244,6 +3369,10 @@ void Print::_make_wipe_tower()
             }
             wipe_tower.set_filament_categories(categories);
 
+            if (m_wipe_tower_plan_cache.restore(plan, m_wipe_tower_data, m_fake_wipe_tower))
+                // The tool changes were planned the same way as the last time, reuse the wipe tower generated then.
+                return;
+
             // Generate the wipe tower layers.
             m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
             wipe_tower.generate(m_wipe_tower_data.tool_changes);
@@ -3292,6 +3421,7 @@ void Print::_make_wipe_tower()
         // Initialize the wipe tower.
         WipeTower2 wipe_tower(m_config, m_default_region_config, m_plate_index, m_origin, wipe_volumes,
                               m_wipe_tower_data.tool_ordering.first_extruder());
+        plan.generator = WipeTowerPlan::Generator::WipeTower2;
 
         // wipe_tower.set_retract();
         // wipe_tower.set_zhop();
@@ -3313,6 +3443,7 @@ void Print::_make_wipe_tower()
                 bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
                 wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height, current_extruder_id,
                                            current_extruder_id, false);
+                plan.add_tool_change(layer_tools, current_extruder_id, current_extruder_id);
                 for (const auto extruder_id : layer_tools.extruders) {
                     if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) ||  extruder_id !=
                         current_extruder_id) {
@@ -3334,6 +3465,7 @@ void Print::_make_wipe_tower()
                         // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
                         wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
                                                    current_extruder_id, extruder_id, volume_to_wipe);
+                        plan.add_tool_change(layer_tools, current_extruder_id, extruder_id, volume_to_wipe);
                         current_extruder_id = extruder_id;
                     }
                 }
@@ -3343,6 +3475,10 @@ void Print::_make_wipe_tower()
             }
         }
 
+        if (m_wipe_tower_plan_cache.restore(plan, m_wipe_tower_data, m_fake_wipe_tower))
+            // The tool changes were planned the same way as the last time, reuse the wipe tower generated then.
+            return;
+
         // Generate the wipe tower layers.
         m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
         wipe_tower.generate(m_wipe_tower_data.tool_changes);
@@ -3379,6 +3515,8 @@ void Print::_make_wipe_tower()
                                                   config().wipe_tower_rotation_angle, config().wipe_tower_cone_angle,
                                                   {scale_(origin.x()), scale_(origin.y())});
     }
+
+    m_wipe_tower_plan_cache.store(std::move(plan), m_wipe_tower_data, m_fake_wipe_tower);
 }
 
 // Generate a recommended G-code output file name based on the format template, default extension, and template parameters
@@ -22,6 +22,7 @@
 
 #include <Eigen/Geometry>
 
+#include <array>
 #include <functional>
 #include <memory>
 #include <set>
@@ -477,19 +478,34 @@ public:
     void                    config_apply_only(const ConfigBase &other, const t_config_option_keys &keys, bool ignore_nonexistent = false) { m_config.apply_only(other, keys, ignore_nonexistent); }
     PrintBase::ApplyStatus  set_instances(PrintInstances &&instances);
     // Invalidates the step, and its depending steps in PrintObject and Print.
+    // As with all the invalidate_*() methods, PrintBase::m_state_mutex should be locked at this point.
     bool                    invalidate_step(PrintObjectStep step);
     // Invalidates all PrintObject and Print steps.
     bool                    invalidate_all_steps();
     // Invalidate steps based on a set of parameters changed.
     // It may be called for both the PrintObjectConfig and PrintRegionConfig.
+    // If z_range is provided, the changed parameters apply to the layers sliced inside this Z range only (layer range or modifier regions),
+    // thus the layer local steps are only invalidated for these layers.
     bool                    invalidate_state_by_config_options(
-        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
+        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+        const t_layer_height_range *z_range = nullptr);
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
     static PrintObjectConfig object_config_from_model_object(const PrintObjectConfig &default_object_config, const ModelObject &object, size_t num_extruders);
 
 private:
+    // Hides Inherited::invalidate_steps(), so that the steps invalidated as a whole forget about their invalidated layers.
+    bool                    invalidate_steps(std::initializer_list<PrintObjectStep> il);
+    // Invalidates a layer local step (posInfill, posIroning, posSimplifyInfill) and its depending steps
+    // just for the layers with slice_z inside z_range, the other layers keep their results.
+    bool                    invalidate_step_layers(PrintObjectStep step, const t_layer_height_range &z_range);
+    // Indices of layers to be computed by a step, which has just been started.
+    // All layers, unless the step was invalidated by invalidate_step_layers() only.
+    std::vector<size_t>     layers_to_process(PrintObjectStep step);
+    // To be called after set_done(step) of a step using layers_to_process().
+    void                    clear_invalidated_layers(PrintObjectStep step);
+
     void make_perimeters();
     void prepare_infill();
     void infill();
@@ -552,6 +568,16 @@ private:
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
 
+    // Layers of a step to be recomputed, if the step was invalidated by invalidate_step_layers() only.
+    // Guarded by the state mutex, as the steps themselves: the invalidate_*() methods write it with the state mutex
+    // held by their caller (Print::apply(), Print::clear()), the background processing locks the mutex to read or clear it.
+    struct InvalidatedLayers {
+        // If false, all layers are to be recomputed once the step is invalid.
+        bool                                partial { false };
+        std::vector<t_layer_height_range>   z_ranges;
+    };
+    std::array<InvalidatedLayers, posCount> m_invalidated_layers;
+
     std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
     std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
 
@@ -671,6 +697,89 @@ private:
 	WipeTowerData &operator=(const WipeTowerData & /* rhs */) = delete;
 };
 
+// Inputs of the wipe tower generation: the tool changes planned for the wipe tower layers and the configuration.
+struct WipeTowerPlan
+{
+    enum class Generator { None, WipeTower, WipeTower2, WipeTowerCreality, WipeTowerCrealityCFS };
+
+    struct ToolChange
+    {
+        float        print_z;
+        float        layer_height;
+        unsigned int old_tool;
+        unsigned int new_tool;
+        float        wipe_volume;
+        float        purge_volume;
+
+        bool operator==(const ToolChange &rhs) const {
+            return print_z == rhs.print_z && layer_height == rhs.layer_height && old_tool == rhs.old_tool && new_tool == rhs.new_tool &&
+                   wipe_volume == rhs.wipe_volume && purge_volume == rhs.purge_volume;
+        }
+    };
+
+    Generator                   generator { Generator::None };
+    PrintConfig                 config;
+    PrintRegionConfig           region_config;
+    int                         plate_index { -1 };
+    Vec3d                       origin { Vec3d::Zero() };
+    unsigned int                first_extruder { 0 };
+    std::vector<unsigned int>   all_extruders;
+    // The last layer of the tool ordering and the object layer height determine where the final purge is placed.
+    coordf_t                    last_print_z { 0. };
+    size_t                      last_partitions { 0 };
+    coordf_t                    object_layer_height { 0. };
+    coordf_t                    first_layer_height { 0. };
+    // Tool changes in the order they were planned. A layer starts with a tool change to the current tool.
+    std::vector<ToolChange>     tool_changes;
+    // Layers, at which the extruder fill of the last layer was disabled due to the timelapse.
+    std::vector<float>          no_extruder_fill_layers;
+
+    void add_tool_change(const LayerTools &layer_tools, unsigned int old_tool, unsigned int new_tool, float wipe_volume = 0.f, float purge_volume = 0.f) {
+        tool_changes.push_back({ float(layer_tools.print_z), float(layer_tools.wipe_tower_layer_height), old_tool, new_tool, wipe_volume, purge_volume });
+    }
+
+    bool operator==(const WipeTowerPlan &rhs) const;
+};
+
+// psWipeTower is invalidated together with any object step, though the wipe tower only depends on its plan.
+// The results of the last wipe tower generation are kept together with the plan they were generated from
+// and they are reused if the objects were processed again without changing the planned tool changes,
+// for example after changing the infill density or the seam position.
+class WipeTowerPlanCache
+{
+public:
+    // Remember the plan, from which the results just stored into data were generated.
+    void store(WipeTowerPlan &&plan, const WipeTowerData &data, const FakeWipeTower &fake_wipe_tower);
+    // Take over the results of the last wipe tower generation before data is cleared.
+    void stash(WipeTowerData &data);
+    // Move the stashed results back into data if they were generated from the same plan, otherwise drop them.
+    bool restore(const WipeTowerPlan &plan, WipeTowerData &data, FakeWipeTower &fake_wipe_tower);
+    void clear();
+
+private:
+    WipeTowerPlan                                             m_plan;
+    // m_plan describes the results in WipeTowerData, or stashed here if m_stashed is set.
+    bool                                                      m_valid { false };
+    bool                                                      m_stashed { false };
+
+    // Results moved out of WipeTowerData by stash().
+    std::unique_ptr<std::vector<WipeTower::ToolChangeResult>> m_priming;
+    std::vector<std::vector<WipeTower::ToolChangeResult>>     m_tool_changes;
+    std::unique_ptr<WipeTower::ToolChangeResult>              m_final_purge;
+    std::optional<WipeTowerData::WipeTowerMeshData>           m_wipe_tower_mesh_data;
+
+    // Results copied from WipeTowerData by store(), as some of them are overwritten by estimates when psWipeTower is invalidated.
+    std::vector<float>                                        m_used_filament;
+    int                                                       m_number_of_toolchanges { -1 };
+    float                                                     m_depth { 0.f };
+    std::vector<std::pair<float, float>>                      m_z_and_depth_pairs;
+    float                                                     m_brim_width { 0.f };
+    float                                                     m_height { 0.f };
+    BoundingBoxf                                              m_bbx;
+    Polygon                                                   m_stable_cone;
+    FakeWipeTower                                             m_fake_wipe_tower;
+};
+
 struct PrintStatistics
 {
     PrintStatistics() { clear(); }
@@ -686,6 +795,10 @@ struct PrintStatistics
     unsigned int                    initial_tool;
     unsigned int                    total_layer_count;
     std::map<size_t, double>        filament_stats;
+    // Number of volumes sliced by Print::process() and how many of them were reused from the MeshSlicesCache,
+    // for example sliced already for another plate. Reset by Print::process(), not by clear(), which is called by the G-code export.
+    size_t                          sliced_volumes { 0 };
+    size_t                          sliced_volumes_cached { 0 };
 
     // Config with the filled in print statistics.
     DynamicConfig           config() const;
@@ -977,6 +1090,7 @@ private:
     // Following section will be consumed by the GCodeGenerator.
     ToolOrdering 							m_tool_ordering;
     WipeTowerData                           m_wipe_tower_data {m_tool_ordering};
+    WipeTowerPlanCache                      m_wipe_tower_plan_cache;
 
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
@@ -712,8 +712,34 @@ void print_region_ref_inc(PrintRegion &r) { ++ r.m_ref_cnt; }
 void print_region_ref_reset(PrintRegion &r) { r.m_ref_cnt = 0; }
 int  print_region_ref_cnt(const PrintRegion &r) { return r.m_ref_cnt; }
 
+// Z range of the object, where a PrintRegion may produce some slices: Union of the layer ranges referencing the region,
+// each clipped by the bounding box of the volume producing the region.
+static t_layer_height_range print_region_z_range(const PrintObjectRegions &print_object_regions, const PrintRegion &region)
+{
+    t_layer_height_range out { std::numeric_limits<coordf_t>::max(), std::numeric_limits<coordf_t>::lowest() };
+    auto extend = [&out](coordf_t z_min, coordf_t z_max) {
+        out.first  = std::min(out.first, z_min);
+        out.second = std::max(out.second, z_max);
+    };
+    for (const PrintObjectRegions::LayerRangeRegions &layer_range : print_object_regions.layer_ranges) {
+        for (const PrintObjectRegions::VolumeRegion &volume_region : layer_range.volume_regions)
+            if (volume_region.region == &region) {
+                if (volume_region.bbox)
+                    extend(std::max<coordf_t>(layer_range.layer_height_range.first, volume_region.bbox->min().z()),
+                           std::min<coordf_t>(layer_range.layer_height_range.second, volume_region.bbox->max().z()));
+                else
+                    extend(layer_range.layer_height_range.first, layer_range.layer_height_range.second);
+            }
+        for (const PrintObjectRegions::PaintedRegion &painted_region : layer_range.painted_regions)
+            if (painted_region.region == &region)
+                extend(layer_range.layer_height_range.first, layer_range.layer_height_range.second);
+    }
+    return out;
+}
+
 // Verify whether the PrintRegions of a PrintObject are still valid, possibly after updating the region configs.
 // Before region configs are updated, callback_invalidate() is called to possibly stop background processing.
+// callback_invalidate() receives the Z range of the object, where the updated region may produce some slices.
 // Returns false if this object needs to be resliced because regions were merged or split.
 bool verify_update_print_object_regions(
     ModelVolumePtrs                     model_volumes,
@@ -721,7 +747,7 @@ bool verify_update_print_object_regions(
     size_t                              num_extruders,
     const std::vector<unsigned int>    &painting_extruders,
     PrintObjectRegions                 &print_object_regions,
-    const std::function<void(const PrintRegionConfig&, const PrintRegionConfig&, const t_config_option_keys&)> &callback_invalidate)
+    const std::function<void(const PrintRegionConfig&, const PrintRegionConfig&, const t_config_option_keys&, const t_layer_height_range&)> &callback_invalidate)
 {
     // Sort by ModelVolume ID.
     model_volumes_sort_by_id(model_volumes);
@@ -782,7 +808,7 @@ bool verify_update_print_object_regions(
                         // Region is referenced for the first time. Just change its parameters.
                         // Stop the background process before assigning new configuration to the regions.
                         t_config_option_keys diff = region.region->config().diff(cfg);
-                        callback_invalidate(region.region->config(), cfg, diff);
+                        callback_invalidate(region.region->config(), cfg, diff, print_region_z_range(print_object_regions, *region.region));
                         region.region->config_apply_only(cfg, diff, false);
                         if (std::find(diff.begin(), diff.end(), "wall_loops") != diff.end()) {
                             // diff contains "wall_loops"
@@ -813,7 +839,7 @@ bool verify_update_print_object_regions(
                     // Region is referenced for the first time. Just change its parameters.
                     // Stop the background process before assigning new configuration to the regions.
                     t_config_option_keys diff = region.region->config().diff(cfg);
-                    callback_invalidate(region.region->config(), cfg, diff);
+                    callback_invalidate(region.region->config(), cfg, diff, print_region_z_range(print_object_regions, *region.region));
                     region.region->config_apply_only(cfg, diff, false);
                 } else {
                     // Region is referenced multiple times, thus the region is being split. We need to reslice.
@@ -1936,10 +1962,10 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                     num_extruders ,
                     painting_extruders,
                     *print_object_regions,
-                    [it_print_object, it_print_object_end, &update_apply_status](const PrintRegionConfig &old_config, const PrintRegionConfig &new_config, const t_config_option_keys &diff_keys) {
+                    [it_print_object, it_print_object_end, &update_apply_status](const PrintRegionConfig &old_config, const PrintRegionConfig &new_config, const t_config_option_keys &diff_keys, const t_layer_height_range &z_range) {
                         for (auto it = it_print_object; it != it_print_object_end; ++it)
                             if ((*it)->m_shared_regions != nullptr)
-                                update_apply_status((*it)->invalidate_state_by_config_options(old_config, new_config, diff_keys));
+                                update_apply_status((*it)->invalidate_state_by_config_options(old_config, new_config, diff_keys, &z_range));
                     })) {
                     // Regions are valid, just keep them.
                 } else {
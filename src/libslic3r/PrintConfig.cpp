@@ -8185,6 +8185,28 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "assemble_list.json";
     def->set_default_value(new ConfigOptionString());
 
+    def = this->add("parallel_plates", coInt);
+    def->label = "Parallel plates";
+    def->tooltip = "Number of plates sliced concurrently when slicing all plates. Each plate is sliced by its own print "
+                   "and the G-code is exported in plate order. 0 or 1 slices the plates one by one.";
+    def->cli_params = "count";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("parallel_plates_threads", coInt);
+    def->label = "Parallel plates threads";
+    def->tooltip = "Total number of threads split evenly between the plates sliced concurrently. 0 uses all available threads.";
+    def->cli_params = "count";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("server", coBool);
+    def->label = "Slice server";
+    def->tooltip = "Keep running and slice the requests read from stdin, one JSON object per line with the command line args of each job, "
+                   "for example {\"id\": 1, \"args\": [\"--slice\", \"0\", \"model.3mf\"]}. The other options of the server are prepended to the args "
+                   "of each job. The parsed presets and other caches are kept warm between the jobs. {\"exit\": true} stops the server.";
+    def->set_default_value(new ConfigOptionBool(false));
+
     /*def = this->add("output", coString);
     def->label = L("Output File");
     def->tooltip = L("The file where the output will be written (if not specified, it will be based on the input file).");
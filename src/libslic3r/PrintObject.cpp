@@ -18,7 +18,6 @@
 #include "Fill/FillAdaptive.hpp"
 #include "Fill/FillLightning.hpp"
 #include "Format/STL.hpp"
-#include "TreeSupport.hpp"
 #include "format.hpp"
 #include "libslic3r/ModelInstance.hpp"
 #include "libslic3r/ModelVolume.hpp"
@@ -28,6 +27,7 @@
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <numeric>
 #include <string_view>
 #include <utility>
 
@@ -689,14 +689,15 @@ void PrintObject::infill()
         m_print->set_status(35, L("Generating infill toolpath"));
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
+        const std::vector<size_t> layers = this->layers_to_process(posInfill);
 
-        BOOST_LOG_TRIVIAL(error) << "Filling layers in parallel - start";
+        BOOST_LOG_TRIVIAL(error) << "Filling " << layers.size() << " of " << m_layers.size() << " layers in parallel - start";
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            tbb::blocked_range<size_t>(0, layers.size()),
+            [this, &layers, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->center_offset(), this->m_lightning_generator.get());
+                    m_layers[layers[i]]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->center_offset(), this->m_lightning_generator.get());
                 }
             }
         );
@@ -706,6 +707,7 @@ void PrintObject::infill()
         ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
         */
         this->set_done(posInfill);
+        this->clear_invalidated_layers(posInfill);
 
         debug_infills(m_print, this);
     }
@@ -720,20 +722,23 @@ void PrintObject::infill()
 void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
+        // Only the layers with regenerated infill are ironed again, the other layers keep their ironing.
+        const std::vector<size_t> layers = this->layers_to_process(posIroning);
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            tbb::blocked_range<size_t>(0, layers.size()),
+            [this, &layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_ironing();
+                    m_layers[layers[i]]->make_ironing();
                 }
             }
         );
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - end";
         this->set_done(posIroning);
+        this->clear_invalidated_layers(posIroning);
     }
 }
 
@@ -882,20 +887,22 @@ void PrintObject::simplify_extrusion_path()
     if (this->set_started(posSimplifyInfill)) {
         //DEFINE_PERFORMANCE_TEST("Optimizing toolpath2 75%");
         m_print->set_status(75, L("Optimizing toolpath"));
+        const std::vector<size_t> layers = this->layers_to_process(posSimplifyInfill);
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - start";
         //BBS: infills
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            tbb::blocked_range<size_t>(0, layers.size()),
+            [this, &layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++i) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->simplify_infill_extrusion_path();
+                    m_layers[layers[i]]->simplify_infill_extrusion_path();
                 }
             }
         );
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - end";
         this->set_done(posSimplifyInfill);
+        this->clear_invalidated_layers(posSimplifyInfill);
     }
 
     if (this->set_started(posSimplifySupportPath)) {
@@ -1046,7 +1053,8 @@ SupportLayerPtrs::iterator PrintObject::insert_support_layer(SupportLayerPtrs::i
 // Called by Print::apply().
 // This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
 bool PrintObject::invalidate_state_by_config_options(
-    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys)
+    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+    const t_layer_height_range *z_range)
 {
     if (opt_keys.empty())
         return false;
@@ -1372,12 +1380,16 @@ bool PrintObject::invalidate_state_by_config_options(
 
     sort_remove_duplicates(steps);
     for (PrintObjectStep step : steps)
-        invalidated |= this->invalidate_step(step);
+        // Infill is generated for each layer separately, thus only the layers affected by a layer range or a modifier are regenerated.
+        // Steps preceding posInfill are invalidated as a whole, as they combine the data of neighbor layers.
+        // Sorted steps invalidate posInfill as a whole before it is invalidated partially.
+        invalidated |= z_range != nullptr && step == posInfill ? this->invalidate_step_layers(step, *z_range) : this->invalidate_step(step);
     return invalidated;
 }
 
 bool PrintObject::invalidate_step(PrintObjectStep step)
 {
+    m_invalidated_layers[step] = {};
 	bool invalidated = Inherited::invalidate_step(step);
 
     // propagate to dependent steps
@@ -1414,9 +1426,71 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+    for (InvalidatedLayers &layers : m_invalidated_layers)
+        layers = {};
 	return result;
 }
 
+bool PrintObject::invalidate_steps(std::initializer_list<PrintObjectStep> il)
+{
+    for (PrintObjectStep step : il)
+        m_invalidated_layers[step] = {};
+    return Inherited::invalidate_steps(il);
+}
+
+bool PrintObject::invalidate_step_layers(PrintObjectStep step, const t_layer_height_range &z_range)
+{
+    assert(step == posInfill || step == posIroning || step == posSimplifyInfill);
+    InvalidatedLayers &layers = m_invalidated_layers[step];
+    if (this->is_step_done_unguarded(step)) {
+        layers.partial  = true;
+        layers.z_ranges = { z_range };
+    } else if (layers.partial)
+        layers.z_ranges.emplace_back(z_range);
+    // Otherwise the step is already invalidated as a whole.
+    bool invalidated = Inherited::invalidate_step(step);
+
+    // propagate to dependent steps
+    if (step == posInfill) {
+        invalidated |= this->invalidate_step_layers(posIroning, z_range);
+        invalidated |= this->invalidate_step_layers(posSimplifyInfill, z_range);
+        invalidated |= m_print->invalidate_steps({ psSkirtBrim });
+    }
+    invalidated |= m_print->invalidate_step(psWipeTower);
+    invalidated |= m_print->invalidate_step(psGCodeExport);
+    return invalidated;
+}
+
+std::vector<size_t> PrintObject::layers_to_process(PrintObjectStep step)
+{
+    std::vector<size_t> layers;
+    {
+        std::scoped_lock<std::mutex> lock(PrintObjectBase::state_mutex(m_print));
+        if (const InvalidatedLayers &invalidated = m_invalidated_layers[step]; invalidated.partial) {
+            // Same test as when distributing slices into layer ranges, see slices_to_regions().
+            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
+                const coordf_t z = m_layers[layer_idx]->slice_z;
+                if (std::any_of(invalidated.z_ranges.begin(), invalidated.z_ranges.end(),
+                        [z](const t_layer_height_range &range) { return range.first - EPSILON <= z && z < range.second + EPSILON; }))
+                    layers.emplace_back(layer_idx);
+            }
+            return layers;
+        }
+        // The depending steps will have to process all layers as well.
+        if (step == posInfill)
+            m_invalidated_layers[posIroning] = m_invalidated_layers[posSimplifyInfill] = {};
+    }
+    layers.assign(m_layers.size(), 0);
+    std::iota(layers.begin(), layers.end(), 0);
+    return layers;
+}
+
+void PrintObject::clear_invalidated_layers(PrintObjectStep step)
+{
+    std::scoped_lock<std::mutex> lock(PrintObjectBase::state_mutex(m_print));
+    m_invalidated_layers[step] = {};
+}
+
 // This function analyzes slices of a region (SurfaceCollection slices).
 // Each region slice (instance of Surface) is analyzed, whether it is supported or whether it is the top surface.
 // Initially all slices are of type stInternal.
@@ -1,6 +1,7 @@
 #include "ElephantFootCompensation.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
+#include "MeshSlicesCache.hpp"
 #include "MultiMaterialSegmentation.hpp"
 #include "Print.hpp"
 #include "ClipperUtils.hpp"
@@ -60,23 +61,48 @@ LayerPtrs new_layers(
     return out;
 }
 
+// Number of volumes sliced and how many of them were taken from the MeshSlicesCache.
+struct VolumeSlicingStats
+{
+    size_t sliced { 0 };
+    size_t cached { 0 };
+};
+
 // Slice single triangle mesh.
+// The slices are shared through the MeshSlicesCache with the other Prints (plates) slicing the same mesh.
 static std::vector<ExPolygons> slice_volume(
     const ModelVolume             &volume,
     const std::vector<float>      &zs,
     const MeshSlicingParamsEx     &params,
-    const std::function<void()>   &throw_on_cancel_callback)
+    const std::function<void()>   &throw_on_cancel_callback,
+    VolumeSlicingStats            *stats = nullptr)
 {
     std::vector<ExPolygons> layers;
     if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
+        std::shared_ptr<const TriangleMesh> mesh = volume.mesh_ptr();
+        if (mesh->its.indices.size() > 0) {
             MeshSlicingParamsEx params2 { params };
             params2.trafo = params2.trafo * volume.get_matrix();
-            if (params2.trafo.rotation().determinant() < 0.)
-                its_flip_triangles(its);
-            layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
+            if (stats)
+                ++ stats->sliced;
+            if (MeshSlicesCache::instance().find(mesh, zs, params2, layers)) {
+                if (stats)
+                    ++ stats->cached;
+                return layers;
+            }
+            // The transformed and Z sorted mesh is kept for slicing the volume again, for example by the support volumes
+            // or after the layer heights changed.
+            std::shared_ptr<const MeshSlicingContext> context = MeshSlicesCache::instance().find_context(mesh, params2.trafo);
+            if (! context) {
+                indexed_triangle_set its = mesh->its;
+                if (params2.trafo.rotation().determinant() < 0.)
+                    its_flip_triangles(its);
+                context = std::make_shared<const MeshSlicingContext>(its, params2.trafo, throw_on_cancel_callback);
+                MeshSlicesCache::instance().store_context(mesh, params2.trafo, context);
+            }
+            layers = slice_mesh_ex(*context, zs, params2, throw_on_cancel_callback);
             throw_on_cancel_callback();
+            MeshSlicesCache::instance().store(mesh, zs, params2, layers);
         }
     }
     return layers;
@@ -89,13 +115,14 @@ static std::vector<ExPolygons> slice_volume(
     const std::vector<float>                    &z,
     const std::vector<t_layer_height_range>     &ranges,
     const MeshSlicingParamsEx                   &params,
-    const std::function<void()>                 &throw_on_cancel_callback)
+    const std::function<void()>                 &throw_on_cancel_callback,
+    VolumeSlicingStats                          *stats)
 {
     std::vector<ExPolygons> out;
     if (! z.empty() && ! ranges.empty()) {
         if (ranges.size() == 1 && z.front() >= ranges.front().first && z.back() < ranges.front().second) {
             // All layers fit into a single range.
-            out = slice_volume(volume, z, params, throw_on_cancel_callback);
+            out = slice_volume(volume, z, params, throw_on_cancel_callback, stats);
         } else {
             std::vector<float>                     z_filtered;
             std::vector<std::pair<size_t, size_t>> n_filtered;
@@ -111,7 +138,7 @@ static std::vector<ExPolygons> slice_volume(
                     n_filtered.emplace_back(std::make_pair(first, i));
             }
             if (! n_filtered.empty()) {
-                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback, stats);
                 out.assign(z.size(), ExPolygons());
                 i = 0;
                 for (const std::pair<size_t, size_t> &span : n_filtered)
@@ -139,7 +166,8 @@ static std::vector<VolumeSlices> slice_volumes_inner(
     ModelVolumePtrs                                           model_volumes,
     const std::vector<PrintObjectRegions::LayerRangeRegions> &layer_ranges,
     const std::vector<float>                                 &zs,
-    const std::function<void()>                              &throw_on_cancel_callback)
+    const std::function<void()>                              &throw_on_cancel_callback,
+    VolumeSlicingStats                                       &stats)
 {
     model_volumes_sort_by_id(model_volumes);
 
@@ -194,7 +222,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                     }
                     out.push_back({
                         model_volume->id(),
-                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback, &stats)
                     });
                 }
             } else {
@@ -206,7 +234,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                 if (! slicing_ranges.empty())
                     out.push_back({
                         model_volume->id(),
-                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback, &stats)
                     });
             }
             if (! out.empty() && out.back().slices.empty())
@@ -1084,9 +1112,12 @@ void PrintObject::slice_volumes()
     std::vector<float>                   slice_zs      = zs_from_layers(m_layers);
     std::vector<VolumeSlices> objSliceByVolume;
     if (!slice_zs.empty()) {
+        VolumeSlicingStats stats;
         objSliceByVolume = slice_volumes_inner(
             print->config(), this->config(), this->trafo_centered(),
-            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, throw_on_cancel_callback);
+            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, throw_on_cancel_callback, stats);
+        m_print->print_statistics().sliced_volumes        += stats.sliced;
+        m_print->print_statistics().sliced_volumes_cached += stats.cached;
     }
 
     //BBS: "model_part" volumes are grouded according to their connections
@@ -2,7 +2,11 @@
 #include <tuple>
 #include <optional>
 #include "MutablePriorityQueue.hpp"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
 
 using namespace Slic3r;
 
@@ -83,6 +87,7 @@ namespace QuadricEdgeCollapse {
     struct VertexInfo {
         SymMat q; // sum quadric of surround triangles
         uint32_t start = 0, count = 0; // vertex neighbor triangles
+        bool locked = false; // shared with another part of the mesh, must not be moved nor removed
         VertexInfo() = default;
         bool is_deleted() const { return count == 0; }
     };
@@ -116,7 +121,8 @@ namespace QuadricEdgeCollapse {
     double vertex_error(const SymMat &q, const Vec3d &vertex);
     SymMat create_quadric(const Triangle &t, const Vec3d& n, const Vertices &vertices);
     std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-    init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
+    init(const indexed_triangle_set &its, const std::vector<bool> &locked_vertices, const std::vector<SymMat> &vertex_quadrics,
+         ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
     std::optional<uint32_t> find_triangle_index1(uint32_t vi, const VertexInfo& v_info,
         uint32_t ti, const EdgeInfos& e_infos, const Indices& indices);
     void reorder_edges(EdgeInfos &e_infos, const VertexInfo &v_info, uint32_t ti0, uint32_t ti1);
@@ -134,6 +140,27 @@ namespace QuadricEdgeCollapse {
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
     void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
+    bool has_locked_vertex(const Triangle &t, const VertexInfos &v_infos);
+    // Collapse edges until the triangle_count is reached or the error of the cheapest edge reaches maximal_error.
+    // Triangles touching a locked vertex are kept. Returns the error of the last collapsed edge.
+    // When vertex_quadrics is set, its non empty content is used in place of the quadrics of surrounding triangles
+    // and it is filled with the accumulated quadrics of the simplified mesh on output.
+    float collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error,
+        const std::vector<bool> &locked_vertices, std::vector<SymMat> *vertex_quadrics,
+        ThrowOnCancel &throw_on_cancel, StatusFn &status_fn);
+
+    // Part of a mesh simplified independently of the other parts.
+    struct Part {
+        indexed_triangle_set  its;
+        // Indices of the vertices shared with other parts in the source mesh,
+        // these are stored first in its.vertices and they are locked.
+        std::vector<uint32_t> shared_vertices;
+        // Quadrics of the simplified part.
+        std::vector<SymMat>   quadrics;
+    };
+    // Split mesh into slabs with the same count of triangles along the longest side of its bounding box.
+    std::vector<Part> split_to_slabs(const indexed_triangle_set &its, size_t count);
+    void merge_parts(const std::vector<Part> &parts, size_t vertices_count, indexed_triangle_set &its, std::vector<SymMat> &quadrics);
 
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
@@ -153,6 +180,14 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+    // simplification of the parts of a partitioned mesh, the rest is the final serial pass
+    const int status_parts_size = 80; // in percents
+    // minimal count of triangles in one part of a mesh simplified in parallel
+    const size_t partition_triangle_count = 1000000;
+    // maximal count of parts, fixed so that the result does not depend on the count of CPU cores
+    const size_t partitions_max_count = 8;
+    // parts are reduced to this multiple of the wanted triangle ratio, the rest is left for the final pass
+    const uint64_t part_reduction_reserve = 2;
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -163,6 +198,31 @@ void Slic3r::its_quadric_edge_collapse(
     float *                   max_error,
     std::function<void(void)> throw_on_cancel,
     std::function<void(int)>  status_fn)
+{
+    size_t partitions_count = std::min(its.indices.size() / partition_triangle_count, partitions_max_count);
+    if (partitions_count > 1) {
+        its_quadric_edge_collapse_partitioned(its, partitions_count, triangle_count, max_error, throw_on_cancel, status_fn);
+        return;
+    }
+
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    float last_collapsed_error = collapse(its, triangle_count, maximal_error, {}, nullptr, throw_on_cancel, status_fn);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+void Slic3r::its_quadric_edge_collapse_partitioned(
+    indexed_triangle_set &    its,
+    size_t                    partitions_count,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn)
 {
     // check input
     if (triangle_count >= its.indices.size()) return;
@@ -170,6 +230,82 @@ void Slic3r::its_quadric_edge_collapse(
     if (maximal_error <= 0.f) return;
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
+    partitions_count = std::clamp(partitions_count, size_t(1), its.indices.size());
+
+    std::vector<Part> parts = split_to_slabs(its, partitions_count);
+    throw_on_cancel();
+
+    // Status of the parts is weighted by their triangle count and reported only when it grows.
+    std::vector<size_t> parts_size;
+    for (const Part &part : parts) parts_size.emplace_back(part.its.indices.size());
+    std::vector<std::atomic<int>> parts_status(parts.size());
+    std::mutex status_mutex;
+    int        last_status = -1;
+    auto report_parts_status = [&]() {
+        double status = 0.;
+        for (size_t i = 0; i < parts.size(); ++i)
+            status += double(parts_status[i].load()) * parts_size[i] / its.indices.size();
+        std::lock_guard<std::mutex> lock(status_mutex);
+        int percent = static_cast<int>(std::round(status * status_parts_size / 100.));
+        if (percent > last_status) {
+            last_status = percent;
+            status_fn(percent);
+        }
+    };
+
+    std::vector<float> parts_error(parts.size(), 0.f);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, parts.size(), 1),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            Part &part = parts[i];
+            std::vector<bool> locked(part.its.vertices.size(), false);
+            std::fill(locked.begin(), locked.begin() + part.shared_vertices.size(), true);
+            // Triangles touching the locked vertices are kept for the final pass. The rest of the part
+            // is reduced only partially, so that the final pass still selects the cheapest edges globally.
+            uint32_t locked_count = std::count_if(part.its.indices.begin(), part.its.indices.end(), [&locked](const Triangle &t) {
+                return locked[t[0]] || locked[t[1]] || locked[t[2]];
+            });
+            uint32_t unlocked_count = part.its.indices.size() - locked_count;
+            uint32_t part_triangle_count = locked_count + std::min(unlocked_count, static_cast<uint32_t>(
+                uint64_t(triangle_count) * part_reduction_reserve * unlocked_count / its.indices.size()));
+            StatusFn part_status_fn = [&parts_status, &report_parts_status, i](int percent) {
+                parts_status[i] = percent;
+                report_parts_status();
+            };
+            parts_error[i] = collapse(part.its, part_triangle_count, maximal_error, locked, &part.quadrics, throw_on_cancel, part_status_fn);
+        }
+    }); // END parallel for
+
+    // Quadrics accumulated by the parts are kept, so that the errors of the final pass match the serial simplification.
+    std::vector<SymMat> quadrics;
+    merge_parts(parts, its.vertices.size(), its, quadrics);
+    parts.clear();
+    throw_on_cancel();
+    status_fn(status_parts_size);
+
+    // Final pass over the whole mesh simplifies the seams between the parts.
+    StatusFn seam_status_fn = [&status_fn](int percent) {
+        status_fn(status_parts_size + (percent * (100 - status_parts_size)) / 100);
+    };
+    float last_collapsed_error = *std::max_element(parts_error.begin(), parts_error.end());
+    last_collapsed_error = std::max(last_collapsed_error,
+        collapse(its, triangle_count, maximal_error, {}, &quadrics, throw_on_cancel, seam_status_fn));
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::collapse(indexed_triangle_set &    its,
+                                    uint32_t                  triangle_count,
+                                    float                     maximal_error,
+                                    const std::vector<bool> & locked_vertices,
+                                    std::vector<SymMat> *     vertex_quadrics,
+                                    ThrowOnCancel &           throw_on_cancel,
+                                    StatusFn &                status_fn)
+{
+    if (triangle_count >= its.indices.size()) {
+        if (vertex_quadrics == nullptr) return 0.f;
+        // Nothing to reduce, but the caller still needs the quadrics of the vertices.
+        triangle_count = its.indices.size();
+    }
 
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
@@ -180,7 +316,8 @@ void Slic3r::its_quadric_edge_collapse(
     VertexInfos   v_infos;
     EdgeInfos     e_infos;
     Errors        errors;
-    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn);
+    std::tie(t_infos, v_infos, e_infos, errors) = init(its, locked_vertices,
+        vertex_quadrics == nullptr ? std::vector<SymMat>() : *vertex_quadrics, throw_on_cancel, init_status_fn);
     throw_on_cancel();
     status_fn(status_init_size);
 
@@ -256,6 +393,7 @@ void Slic3r::its_quadric_edge_collapse(
             reorder_edges(e_infos, v_info1, ti0, ti1);
         }
         if (!ti1_opt.has_value() || // edge has only one triangle
+            has_locked_vertex(its.indices[ti1], v_infos) ||
             degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
             degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
             create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
@@ -341,9 +479,16 @@ void Slic3r::its_quadric_edge_collapse(
 #endif // EXPENSIVE_DEBUG_CHECKS
     }
 
+    if (vertex_quadrics != nullptr) {
+        // in the same order as compact() stores the vertices
+        vertex_quadrics->clear();
+        for (const VertexInfo &v_info : v_infos)
+            if (!v_info.is_deleted()) vertex_quadrics->emplace_back(v_info.q);
+    }
+
     // compact triangle
     compact(v_infos, t_infos, e_infos, its);
-    if (max_error != nullptr) *max_error = last_collapsed_error;
+    return last_collapsed_error;
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -438,7 +583,8 @@ SymMat QuadricEdgeCollapse::create_quadric(const Triangle &t,
 }
 
 std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
+QuadricEdgeCollapse::init(const indexed_triangle_set &its, const std::vector<bool> &locked_vertices, const std::vector<SymMat> &vertex_quadrics,
+                          ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
 {
     int status_offset = 0;
     TriangleInfos t_infos(its.indices.size());
@@ -479,6 +625,11 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
         status_offset += status_sum_quadric;
     } // remove triangle quadrics
 
+    for (size_t i = 0; i < locked_vertices.size(); ++i)
+        v_infos[i].locked = locked_vertices[i];
+    for (size_t i = 0; i < vertex_quadrics.size(); ++i)
+        v_infos[i].q = vertex_quadrics[i];
+
     // set offseted starts
     uint32_t triangle_start = 0;
     for (VertexInfo &v_info : v_infos) {
@@ -690,10 +841,18 @@ bool QuadricEdgeCollapse::create_no_volume(
     return false;
 }
 
+bool QuadricEdgeCollapse::has_locked_vertex(const Triangle &t, const VertexInfos &v_infos)
+{
+    return v_infos[t[0]].locked || v_infos[t[1]].locked || v_infos[t[2]].locked;
+}
+
 Vec3d QuadricEdgeCollapse::calculate_3errors(const Triangle &   t,
                                              const Vertices &   vertices,
                                              const VertexInfos &v_infos)
 {
+    // triangle touching a locked vertex is never removed
+    if (has_locked_vertex(t, v_infos))
+        return Vec3d::Constant(std::numeric_limits<float>::max());
     Vec3d error;
     for (size_t j = 0; j < 3; ++j) {
         size_t   j2  = (j == 2) ? 0 : (j + 1);
@@ -855,6 +1014,115 @@ void QuadricEdgeCollapse::compact(const VertexInfos &   v_infos,
     its.indices.erase(its.indices.begin() + ti_new, its.indices.end());
 }
 
+std::vector<Part> QuadricEdgeCollapse::split_to_slabs(const indexed_triangle_set &its, size_t count)
+{
+    Vec3f bb_min = its.vertices.front();
+    Vec3f bb_max = bb_min;
+    for (const Vec3f &v : its.vertices) {
+        bb_min = bb_min.cwiseMin(v);
+        bb_max = bb_max.cwiseMax(v);
+    }
+    int axis;
+    (bb_max - bb_min).maxCoeff(&axis);
+
+    // sort triangles by their centroid along the axis
+    std::vector<std::pair<float, uint32_t>> order(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const Triangle &t = its.indices[i];
+            order[i] = { its.vertices[t[0]][axis] + its.vertices[t[1]][axis] + its.vertices[t[2]][axis], uint32_t(i) };
+        }
+    }); // END parallel for
+    tbb::parallel_sort(order.begin(), order.end());
+    auto slab_begin = [&order, count](size_t slab) { return slab * order.size() / count; };
+
+    // vertex is used by a single slab or it is shared
+    const uint32_t no_slab = std::numeric_limits<uint32_t>::max();
+    const uint32_t shared  = no_slab - 1;
+    std::vector<uint32_t> vertex_slab(its.vertices.size(), no_slab);
+    for (uint32_t slab = 0; slab < count; ++slab)
+        for (size_t i = slab_begin(slab); i < slab_begin(slab + 1); ++i)
+            for (size_t j = 0; j < 3; ++j) {
+                uint32_t &vs = vertex_slab[its.indices[order[i].second][j]];
+                if (vs == no_slab) vs = slab;
+                else if (vs != slab) vs = shared;
+            }
+
+    std::vector<Part> parts(count);
+    // index of a vertex used by a single slab inside of its part, written only by the owning slab
+    std::vector<uint32_t> part_vertex(its.vertices.size(), no_slab);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count, 1),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t slab = range.begin(); slab < range.end(); ++slab) {
+            Part &part = parts[slab];
+            size_t begin = slab_begin(slab);
+            size_t end   = slab_begin(slab + 1);
+            // shared vertices are stored first, the simplification keeps them in place
+            std::unordered_map<uint32_t, uint32_t> shared_map;
+            for (size_t i = begin; i < end; ++i)
+                for (size_t j = 0; j < 3; ++j) {
+                    uint32_t vi = its.indices[order[i].second][j];
+                    if (vertex_slab[vi] == shared && shared_map.emplace(vi, uint32_t(part.shared_vertices.size())).second)
+                        part.shared_vertices.emplace_back(vi);
+                }
+            for (uint32_t vi : part.shared_vertices)
+                part.its.vertices.emplace_back(its.vertices[vi]);
+
+            part.its.indices.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                const Triangle &t = its.indices[order[i].second];
+                Triangle part_t;
+                for (size_t j = 0; j < 3; ++j) {
+                    uint32_t vi = t[j];
+                    if (vertex_slab[vi] == shared) {
+                        part_t[j] = shared_map[vi];
+                    } else {
+                        if (part_vertex[vi] == no_slab) {
+                            part_vertex[vi] = uint32_t(part.its.vertices.size());
+                            part.its.vertices.emplace_back(its.vertices[vi]);
+                        }
+                        part_t[j] = part_vertex[vi];
+                    }
+                }
+                part.its.indices.emplace_back(part_t);
+            }
+        }
+    }); // END parallel for
+    return parts;
+}
+
+void QuadricEdgeCollapse::merge_parts(const std::vector<Part> &parts, size_t vertices_count, indexed_triangle_set &its, std::vector<SymMat> &quadrics)
+{
+    its.vertices.clear();
+    its.indices.clear();
+    quadrics.clear();
+    // shared vertices were not moved, they are merged by their index in the source mesh
+    const uint32_t no_index = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> merged_vertex(vertices_count, no_index);
+    for (const Part &part : parts) {
+        assert(part.shared_vertices.size() <= part.its.vertices.size());
+        assert(part.quadrics.size() == part.its.vertices.size());
+        std::vector<uint32_t> part_2_merged(part.its.vertices.size());
+        for (size_t vi = 0; vi < part.its.vertices.size(); ++vi) {
+            uint32_t *merged = vi < part.shared_vertices.size() ? &merged_vertex[part.shared_vertices[vi]] : nullptr;
+            if (merged == nullptr || *merged == no_index) {
+                part_2_merged[vi] = uint32_t(its.vertices.size());
+                its.vertices.emplace_back(part.its.vertices[vi]);
+                quadrics.emplace_back(part.quadrics[vi]);
+                if (merged != nullptr) *merged = part_2_merged[vi];
+            } else {
+                // quadric of a shared vertex is summed from the triangles of all parts
+                assert(its.vertices[*merged] == part.its.vertices[vi]);
+                part_2_merged[vi] = *merged;
+                quadrics[*merged] += part.quadrics[vi];
+            }
+        }
+        for (const Triangle &t : part.its.indices)
+            its.indices.emplace_back(part_2_merged[t[0]], part_2_merged[t[1]], part_2_merged[t[2]]);
+    }
+}
+
 #ifdef EXPENSIVE_DEBUG_CHECKS
 
 // store triangle surrounding to file
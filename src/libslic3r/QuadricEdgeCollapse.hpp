@@ -25,4 +25,21 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Simplify mesh by Quadric metric in parallel.
+/// Mesh is split into slabs, which are simplified concurrently while the vertices
+/// shared between slabs are locked. The seams are simplified by a final serial pass.
+/// its_quadric_edge_collapse() uses it for meshes with millions of triangles,
+/// the count of slabs only depends on the triangle count of the mesh.
+/// </summary>
+/// <param name="partitions_count">Count of slabs to simplify concurrently.</param>
+/// Other parameters are the same as for its_quadric_edge_collapse().
+void its_quadric_edge_collapse_partitioned(
+    indexed_triangle_set &    its,
+    size_t                    partitions_count,
+    uint32_t                  triangle_count  = 0,
+    float *                   max_error       = nullptr,
+    std::function<void(void)> throw_on_cancel = nullptr,
+    std::function<void(int)>  statusfn        = nullptr);
+
 } // namespace Slic3r
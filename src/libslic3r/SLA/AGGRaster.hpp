@@ -56,6 +56,7 @@ protected:
     Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
     
     Trafo m_trafo;
+    TColor m_background;
     Scanline m_scanlines;
     Rasterizer m_rasterizer;
     
@@ -139,6 +140,7 @@ public:
         , m_raw_renderer(m_pixrenderer)
         , m_renderer(m_raw_renderer)
         , m_trafo(trafo)
+        , m_background(background)
     {
         // Visual Studio compiler gives warnings about possible division by zero.
         assert(pd.w_mm != 0 && pd.h_mm != 0);
@@ -168,6 +170,7 @@ public:
     }
     
     void clear(const TColor color) { m_raw_renderer.clear(color); }
+    void clear() override { clear(m_background); }
 };
 
 /*
@@ -206,8 +209,6 @@ public:
         Base::m_buf[row * Base::resolution().width_px + col].get(px);
         return px;
     }
-    
-    void clear() { Base::clear(Colors<TColor>::Black); }
 };
 
 class RasterGrayscaleAAGammaPower: public RasterGrayscaleAA {
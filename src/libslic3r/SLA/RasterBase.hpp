@@ -88,6 +88,10 @@ public:
     /// Draw a polygon with holes.
     virtual void draw(const ExPolygon& poly) = 0;
     
+    /// Fill the whole raster with the background color, so that the same
+    /// buffer can be reused for drawing the next layer.
+    virtual void clear() = 0;
+    
     /// Get the resolution of the raster.
 //    virtual Resolution resolution() const = 0;
 //    virtual PixelDim   pixel_dimensions() const = 0;
@@ -397,11 +397,59 @@ protected:
     virtual std::unique_ptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
 
+private:
+    // Draw and encode the layers [begin, end) into out[idx - begin]. The
+    // rasters are recycled between the layers, so only about as many raster
+    // buffers are allocated as there are worker threads.
+    template<class Fn, class CancelFn, class EP>
+    void encode_layers(size_t               begin,
+                       size_t               end,
+                       sla::EncodedRaster  *out,
+                       Fn                  &drawfn,
+                       CancelFn            &cancelfn,
+                       const EP            &ep)
+    {
+        using Mutex = execution::SpinningMutex<EP>;
+        Mutex mtx;
+        std::vector<std::unique_ptr<sla::RasterBase>> rasters;
+
+        execution::for_each(
+            ep, begin, end,
+            [this, begin, out, &drawfn, &cancelfn, &mtx, &rasters](size_t idx) {
+                if (cancelfn()) return;
+
+                std::unique_ptr<sla::RasterBase> rst;
+                {
+                    std::lock_guard<Mutex> lk(mtx);
+                    if (!rasters.empty()) {
+                        rst = std::move(rasters.back());
+                        rasters.pop_back();
+                    }
+                }
+
+                if (rst)
+                    rst->clear();
+                else
+                    rst = create_raster();
+
+                drawfn(*rst, idx);
+                out[idx - begin] = rst->encode(get_encoder());
+
+                std::lock_guard<Mutex> lk(mtx);
+                rasters.emplace_back(std::move(rst));
+            },
+            execution::max_concurrency(ep));
+    }
+
 public:
     virtual ~SLAArchive() = default;
 
     virtual void apply(const SLAPrinterConfig &cfg) = 0;
 
+    // If true, the layers are not rasterized in advance by draw_layers(), the
+    // archive draws them with stream_layers() while it is being exported.
+    virtual bool streams_layers() const { return false; }
+
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
     template<class Fn, class CancelFn, class EP = ExecutionTBB>
     void draw_layers(
@@ -411,17 +459,33 @@ public:
         const EP & ep       = {})
     {
         m_layers.resize(layer_num);
-        execution::for_each(
-            ep, size_t(0), m_layers.size(),
-            [this, &drawfn, &cancelfn](size_t idx) {
-                if (cancelfn()) return;
+        encode_layers(size_t(0), layer_num, m_layers.data(), drawfn, cancelfn, ep);
+    }
 
-                sla::EncodedRaster &enc = m_layers[idx];
-                auto                rst = create_raster();
-                drawfn(*rst, idx);
-                enc = rst->encode(get_encoder());
-            },
-            execution::max_concurrency(ep));
+    // Draw the layers in windows of a few layers per worker thread and hand
+    // the encoded rasters over to outfn in layer order. Only a single window
+    // of encoded layers is held in memory at a time.
+    // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
+    // OutFn is called serially: void(const sla::EncodedRaster &raster, size_t lyrid);
+    template<class Fn, class OutFn, class CancelFn, class EP = ExecutionTBB>
+    void stream_layers(
+        size_t     layer_num,
+        Fn &&      drawfn,
+        OutFn &&   outfn,
+        CancelFn cancelfn = []() { return false; },
+        const EP & ep       = {})
+    {
+        const size_t window = 2 * std::max(execution::max_concurrency(ep), size_t(1));
+        std::vector<sla::EncodedRaster> encoded(std::min(window, layer_num));
+
+        for (size_t begin = 0; begin < layer_num && !cancelfn(); begin += window) {
+            size_t end = std::min(begin + window, layer_num);
+            encode_layers(begin, end, encoded.data(), drawfn, cancelfn, ep);
+            for (size_t idx = begin; idx < end && !cancelfn(); ++idx) {
+                outfn(encoded[idx - begin], idx);
+                encoded[idx - begin] = {};
+            }
+        }
     }
 };
 
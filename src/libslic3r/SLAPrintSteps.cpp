@@ -1051,6 +1051,10 @@ void SLAPrint::Steps::rasterize()
 {
     if(canceled() || !m_print->m_printer) return;
 
+    // The archive rasterizes the layers itself while being exported, so that
+    // the encoded images of the whole print are never held in memory at once.
+    if (m_print->m_printer->streams_layers()) return;
+
     // coefficient to map the rasterization state (0-99) to the allocated
     // portion (slot) of the process state
     double sd = (100 - max_objstatus) / 100.0;
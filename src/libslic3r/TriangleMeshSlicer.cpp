@@ -17,6 +17,7 @@
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
@@ -508,54 +509,6 @@ void slice_facet_at_zs(
     }
 }
 
-template<typename TransformVertex>
-void get_slice_facet_overhang(
-   // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
-   const std::vector<Vec3f>                         &mesh_vertices,
-   const TransformVertex                            &transform_vertex_fn,
-   const stl_triangle_vertex_indices                &indices,
-   const Vec3i32                                      &edge_ids,
-   // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
-   const std::vector<float>                         &zs,
-   std::array<std::mutex, 64>                       &lines_mutex,
-   std::vector<float> &total_lines,
-   std::vector<float> &overhang_lines)
-{
-   stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
-   stl_vertex normal = face_normal_normalized(vertices);
-
-   Eigen::Vector3f negative_z(0, 0, -1);
-   float v_magnitude = normal.norm();
-   float dot_product = normal.dot(negative_z);
-   float cos_theta = dot_product / v_magnitude;
-   float angle_radians = std::acos(cos_theta);
-   float angle_degrees = angle_radians * 180.0 / M_PI;
-
-   // find facet extents
-   const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
-   const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
-
-   // find layer extents
-   auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z); // first layer whose slice_z is >= min_z
-   auto max_layer = std::upper_bound(min_layer, zs.end(), max_z); // first layer whose slice_z is > max_z
-   int  idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
-
-   for (auto it = min_layer; it != max_layer; ++ it) {
-        IntersectionLine il;
-        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
-        if (min_z != max_z && slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
-            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
-            size_t slice_id = it - zs.begin();
-            boost::lock_guard<std::mutex> l(lines_mutex[slice_id % lines_mutex.size()]);
-            float len = il.length();
-            if (angle_degrees < overhang_threshold_angle) {
-                overhang_lines[slice_id] += len;
-            }
-            total_lines[slice_id] += len;
-        }
-   }
-}
-
 template<typename TransformVertex, typename ThrowOnCancel>
 static inline std::vector<IntersectionLines> slice_make_lines(
     const std::vector<stl_vertex>                   &vertices,
@@ -580,35 +533,49 @@ static inline std::vector<IntersectionLines> slice_make_lines(
     return lines;
 }
 
-template<typename TransformVertex>
-static inline void slice_count_overhang_lines(const std::vector<stl_vertex>&                  vertices,
-                                             const TransformVertex&                          transform_vertex_fn,
-                                             const std::vector<stl_triangle_vertex_indices>& indices,
-                                             const std::vector<Vec3i32>&                     face_edge_ids,
-                                             const std::vector<float>&                       zs,
-                                             std::vector<float>*                             overhang_ratio = nullptr)
+// Sweep the sorted zs over the facets of MeshSlicingContext sorted by their lowest Z, calling
+// visit_fn(slice_id, facet) for each facet crossing zs[slice_id]. The zs are split into a few blocks processed in parallel,
+// each block keeps a list of the facets active at the current slicing plane. visit_fn is called for a single slice_id
+// from a single thread only, in the order of the facets, thus no locking is needed to collect the results per slice.
+template<typename VisitFacet, typename ThrowOnCancel>
+static void slice_sweep_facets(
+    const MeshSlicingContext                        &mesh,
+    // Sorted zs, unscaled.
+    const std::vector<float>                        &zs,
+    VisitFacet                                       visit_fn,
+    const ThrowOnCancel                              throw_on_cancel_fn)
 {
-    std::vector<IntersectionLines> lines(zs.size(), IntersectionLines());
-    std::vector<float>             total_lines(zs.size(), 0.f);
-    std::vector<float>             overhang_lines(zs.size(), 0.f);
-    std::array<std::mutex, 64> lines_mutex;
+    using Facet = MeshSlicingContext::Facet;
+    const std::vector<Facet> &facets = mesh.facets;
+    assert(std::is_sorted(zs.begin(), zs.end()));
+    // Each block starts with a search over the facets below its first plane, thus a few blocks per thread only.
+    const size_t num_blocks = std::min(zs.size(), size_t(4 * std::max(1, tbb::this_task_arena::max_concurrency())));
     tbb::parallel_for(
-        tbb::blocked_range<int>(0, int(indices.size())),
-                        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &lines_mutex,
-                        &overhang_lines, &total_lines](const tbb::blocked_range<int>& range) {
-            for (int face_idx = range.begin(); face_idx < range.end(); ++face_idx) {
-                get_slice_facet_overhang(vertices, transform_vertex_fn,
-                                        indices[face_idx], face_edge_ids[face_idx],
-                                        zs, lines_mutex, total_lines, overhang_lines);
+        tbb::blocked_range<size_t>(0, num_blocks, 1),
+        [&facets, &zs, num_blocks, &visit_fn, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            std::vector<int> active;
+            for (size_t block = range.begin(); block < range.end(); ++ block) {
+                const size_t slice_begin = zs.size() * block / num_blocks;
+                const size_t slice_end   = zs.size() * (block + 1) / num_blocks;
+                const float  z_begin     = zs[slice_begin];
+                // First facet starting above z_begin.
+                auto it_next = std::upper_bound(facets.begin(), facets.end(), z_begin, [](float z, const Facet &f) { return z < f.min_z; });
+                active.clear();
+                for (auto it = facets.begin(); it != it_next; ++ it)
+                    if (it->max_z >= z_begin)
+                        active.emplace_back(int(it - facets.begin()));
+                for (size_t slice_id = slice_begin; slice_id < slice_end; ++ slice_id) {
+                    throw_on_cancel_fn();
+                    const float z = zs[slice_id];
+                    for (; it_next != facets.end() && it_next->min_z <= z; ++ it_next)
+                        active.emplace_back(int(it_next - facets.begin()));
+                    // Drop the facets ending below this plane, keep the rest sorted.
+                    active.erase(std::remove_if(active.begin(), active.end(), [&facets, z](int i) { return facets[i].max_z < z; }), active.end());
+                    for (int i : active)
+                        visit_fn(slice_id, facets[i]);
+                }
             }
-        }
-    );
-   // calc overhang ratio
-   for (size_t i = 0; overhang_ratio && i < zs.size(); ++i) {
-       if (total_lines[i] > 0) {
-           (*overhang_ratio)[i] = overhang_lines[i] / total_lines[i];
-       }
-   }
+        });
 }
 
 template<typename TransformVertex, typename FaceFilter>
@@ -1966,6 +1933,62 @@ static std::vector<stl_vertex> transform_mesh_vertices_for_slicing_overhang(cons
     return out;
 }
 
+MeshSlicingContext::MeshSlicingContext(const indexed_triangle_set &mesh, const Transform3d &trafo, std::function<void()> throw_on_cancel) :
+    vertices(transform_mesh_vertices_for_slicing(mesh, trafo)),
+    indices(mesh.indices),
+    //FIXME see the comment on face_edge_ids in slice_mesh().
+    face_edge_ids(its_face_edge_ids(mesh, throw_on_cancel))
+{
+    facets.reserve(indices.size());
+    for (int face_idx = 0; face_idx < int(indices.size()); ++ face_idx) {
+        const stl_triangle_vertex_indices &face = indices[face_idx];
+        const float z0 = vertices[face(0)].z();
+        const float z1 = vertices[face(1)].z();
+        const float z2 = vertices[face(2)].z();
+        const float min_z = std::min(z0, std::min(z1, z2));
+        const float max_z = std::max(z0, std::max(z1, z2));
+        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
+        if (min_z != max_z)
+            facets.push_back({ min_z, max_z, face_idx });
+    }
+    throw_on_cancel();
+    // Sorted by face index for equal min_z to produce the same lines in the same order with each run.
+    std::sort(facets.begin(), facets.end(), [](const Facet &l, const Facet &r) { return l.min_z < r.min_z || (l.min_z == r.min_z && l.idx < r.idx); });
+}
+
+size_t MeshSlicingContext::memsize() const
+{
+    return sizeof(*this) + vertices.capacity() * sizeof(stl_vertex) + indices.capacity() * sizeof(stl_triangle_vertex_indices) + 
+        face_edge_ids.capacity() * sizeof(Vec3i32) + facets.capacity() * sizeof(Facet);
+}
+
+std::vector<Polygons> slice_mesh(
+    const MeshSlicingContext         &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel)
+{
+    BOOST_LOG_TRIVIAL(debug) << "slice_mesh to polygons, " << mesh.facets.size() << " facets sorted by Z";
+
+    std::vector<IntersectionLines> lines(zs.size(), IntersectionLines());
+    slice_sweep_facets(mesh, zs,
+        [&mesh, &zs, &lines](size_t slice_id, const MeshSlicingContext::Facet &facet) {
+            const stl_triangle_vertex_indices &indices = mesh.indices[facet.idx];
+            stl_vertex vertices[3] { mesh.vertices[indices(0)], mesh.vertices[indices(1)], mesh.vertices[indices(2)] };
+            int  idx_vertex_lowest = (vertices[1].z() == facet.min_z) ? 1 : ((vertices[2].z() == facet.min_z) ? 2 : 0);
+            IntersectionLine il;
+            if (slice_facet(zs[slice_id], vertices, indices, mesh.face_edge_ids[facet.idx], idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                lines[slice_id].emplace_back(il);
+            }
+        }, throw_on_cancel);
+
+    throw_on_cancel();
+
+    return make_loops(lines, params, throw_on_cancel);
+}
+
 std::vector<Polygons> slice_mesh(
     const indexed_triangle_set       &mesh,
     // Unscaled Zs
@@ -1978,12 +2001,12 @@ std::vector<Polygons> slice_mesh(
     std::vector<IntersectionLines> lines;
 
     {
-        //FIXME facets_edges is likely not needed and quite costly to calculate.
-        // Instead of edge identifiers, one shall use a sorted pair of edge vertex indices.
-        // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
-        // to make sure that no code relies on it.
-        std::vector<Vec3i32> face_edge_ids = its_face_edge_ids(mesh);
         if (zs.size() <= 1) {
+            //FIXME facets_edges is likely not needed and quite costly to calculate.
+            // Instead of edge identifiers, one shall use a sorted pair of edge vertex indices.
+            // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
+            // to make sure that no code relies on it.
+            std::vector<Vec3i32> face_edge_ids = its_face_edge_ids(mesh);
             // It likely is not worthwile to copy the vertices. Apply the transformation in place.
             if (is_identity(params.trafo)) {
                 lines = slice_make_lines(
@@ -1994,12 +2017,9 @@ std::vector<Polygons> slice_mesh(
                 Transform3f tf = make_trafo_for_slicing(params.trafo);
                 lines = slice_make_lines(mesh.vertices, [tf](const Vec3f &p) { return tf * p; }, mesh.indices, face_edge_ids, zs, throw_on_cancel);
             }
-        } else {
-            // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
-            lines = slice_make_lines(
-                transform_mesh_vertices_for_slicing(mesh, params.trafo), 
-                [](const Vec3f &p) { return p; },  mesh.indices, face_edge_ids, zs, throw_on_cancel);
-        }
+        } else
+            // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation. Sort the facets by Z.
+            return slice_mesh(MeshSlicingContext(mesh, params.trafo, throw_on_cancel), zs, params, throw_on_cancel);
     }
 
     throw_on_cancel();
@@ -2111,24 +2131,57 @@ std::vector<float> get_mesh_overhang(
     const std::vector<float>         &zs,
     const MeshSlicingParams          &params)
 {
-    std::vector<float> overhang_ratio(zs.size(), 0.f);
-    std::vector<IntersectionLines> lines;
-    std::vector<Vec3i32> face_edge_ids = its_face_edge_ids(mesh);
+    return get_mesh_overhang(MeshSlicingContext(mesh, params.trafo), zs);
+}
+
+std::vector<float> get_mesh_overhang(
+    const MeshSlicingContext         &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs)
+{
+    // Classify the facets as overhangs once, not for each slicing plane crossing them.
+    std::vector<char> facet_overhang(mesh.indices.size(), false);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, mesh.facets.size()), [&mesh, &facet_overhang](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const stl_triangle_vertex_indices &indices = mesh.indices[mesh.facets[i].idx];
+            stl_vertex vertices[3] { mesh.vertices[indices(0)], mesh.vertices[indices(1)], mesh.vertices[indices(2)] };
+            stl_vertex normal = face_normal_normalized(vertices);
+            float cos_theta     = normal.dot(Vec3f(0, 0, -1)) / normal.norm();
+            float angle_degrees = std::acos(cos_theta) * 180.0 / M_PI;
+            facet_overhang[mesh.facets[i].idx] = angle_degrees < overhang_threshold_angle;
+        }
+    });
 
-    slice_count_overhang_lines(
-        //transform_mesh_vertices_for_slicing_overhang(mesh, params.trafo),
-        transform_mesh_vertices_for_slicing(mesh, params.trafo),
-       [](const Vec3f& p) { return p; }, mesh.indices, face_edge_ids, zs,
-        &overhang_ratio);
+    std::vector<float> total_lines(zs.size(), 0.f);
+    std::vector<float> overhang_lines(zs.size(), 0.f);
+    slice_sweep_facets(mesh, zs,
+        [&mesh, &zs, &facet_overhang, &total_lines, &overhang_lines](size_t slice_id, const MeshSlicingContext::Facet &facet) {
+            const stl_triangle_vertex_indices &indices = mesh.indices[facet.idx];
+            stl_vertex vertices[3] { mesh.vertices[indices(0)], mesh.vertices[indices(1)], mesh.vertices[indices(2)] };
+            int  idx_vertex_lowest = (vertices[1].z() == facet.min_z) ? 1 : ((vertices[2].z() == facet.min_z) ? 2 : 0);
+            IntersectionLine il;
+            if (slice_facet(zs[slice_id], vertices, indices, mesh.face_edge_ids[facet.idx], idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                float len = il.length();
+                if (facet_overhang[facet.idx])
+                    overhang_lines[slice_id] += len;
+                total_lines[slice_id] += len;
+            }
+        }, []{});
 
+    // calc overhang ratio
+    std::vector<float> overhang_ratio(zs.size(), 0.f);
+    for (size_t i = 0; i < zs.size(); ++ i)
+        if (total_lines[i] > 0)
+            overhang_ratio[i] = overhang_lines[i] / total_lines[i];
     return overhang_ratio;
 }
 
-std::vector<ExPolygons> slice_mesh_ex(
-    const indexed_triangle_set       &mesh,
-    const std::vector<float>         &zs,
+// slice_mesh_fn(const MeshSlicingParams&) slices the mesh into polygons, which are then converted to expolygons according to params.
+template<typename SliceMesh>
+static std::vector<ExPolygons> slice_mesh_ex_impl(
+    SliceMesh                         slice_mesh_fn,
     const MeshSlicingParamsEx        &params,
-    std::function<void()>             throw_on_cancel)
+    const std::function<void()>      &throw_on_cancel)
 {
     std::vector<Polygons> layers_p;
     {
@@ -2137,7 +2190,7 @@ std::vector<ExPolygons> slice_mesh_ex(
             slicing_params.mode = MeshSlicingParams::SlicingMode::Positive;
         if (params.mode_below == MeshSlicingParams::SlicingMode::PositiveLargestContour)
             slicing_params.mode_below = MeshSlicingParams::SlicingMode::Positive;
-        layers_p = slice_mesh(mesh, zs, slicing_params, throw_on_cancel);
+        layers_p = slice_mesh_fn(slicing_params);
     }
     
 //    BOOST_LOG_TRIVIAL(debug) << "slice_mesh make_expolygons in parallel - start";
@@ -2173,6 +2226,26 @@ std::vector<ExPolygons> slice_mesh_ex(
     return layers;
 }
 
+std::vector<ExPolygons> slice_mesh_ex(
+    const indexed_triangle_set       &mesh,
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel)
+{
+    return slice_mesh_ex_impl([&mesh, &zs, &throw_on_cancel](const MeshSlicingParams &slicing_params) { return slice_mesh(mesh, zs, slicing_params, throw_on_cancel); },
+        params, throw_on_cancel);
+}
+
+std::vector<ExPolygons> slice_mesh_ex(
+    const MeshSlicingContext         &mesh,
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel)
+{
+    return slice_mesh_ex_impl([&mesh, &zs, &throw_on_cancel](const MeshSlicingParams &slicing_params) { return slice_mesh(mesh, zs, slicing_params, throw_on_cancel); },
+        params, throw_on_cancel);
+}
+
 // Slice a triangle set with a set of Z slabs (thick layers).
 // The effect is similar to producing the usual top / bottom layers from a sliced mesh by 
 // subtracting layer[i] from layer[i - 1] for the top surfaces resp.
@@ -3,11 +3,13 @@
 
 #include <functional>
 #include <vector>
+#include <admesh/stl.h>
 #include "Polygon.hpp"
 #include "ExPolygon.hpp"
 
 namespace Slic3r {
 
+// Fields of MeshSlicingParams and MeshSlicingParamsEx are compared by the MeshSlicesCache key, see slicing_params_equal().
 struct MeshSlicingParams
 {
     enum class SlicingMode : uint32_t {
@@ -48,6 +50,32 @@ struct MeshSlicingParamsEx : public MeshSlicingParams
     double        resolution { 0 };
 };
 
+// A mesh prepared for slicing at many Z levels, possibly by multiple slice_mesh() / slice_mesh_ex() / get_mesh_overhang() calls
+// with the same transformation. The vertices are transformed and the edge IDs are calculated just once. The non-horizontal facets
+// are sorted by their lowest Z, thus a sweep over the sorted slicing planes only visits the facets crossing each plane,
+// and each plane is processed by a single thread.
+class MeshSlicingContext
+{
+public:
+    // The triangles of mesh are expected to be flipped already if trafo is mirroring.
+    MeshSlicingContext(const indexed_triangle_set &mesh, const Transform3d &trafo, std::function<void()> throw_on_cancel = []{});
+
+    struct Facet {
+        float   min_z;
+        float   max_z;
+        int     idx;
+    };
+
+    // Vertices transformed by trafo, scaled in XY, not in Z.
+    std::vector<stl_vertex>                     vertices;
+    std::vector<stl_triangle_vertex_indices>    indices;
+    std::vector<Vec3i32>                        face_edge_ids;
+    // Non-horizontal facets sorted by min_z.
+    std::vector<Facet>                          facets;
+
+    size_t memsize() const;
+};
+
 // All the following slicing functions shall produce consistent results with the same mesh, same transformation matrix and slicing parameters.
 // Namely, slice_mesh_slabs() shall produce consistent results with slice_mesh() and slice_mesh_ex() in the sense, that projections made by 
 // slice_mesh_slabs() shall fall onto slicing planes produced by slice_mesh().
@@ -96,11 +124,28 @@ inline std::vector<ExPolygons>  slice_mesh_ex(
     return slice_mesh_ex(mesh, zs, params, throw_on_cancel);
 }
 
+// Slicing of a prepared mesh, params.trafo is ignored in favor of the transformation of the MeshSlicingContext. zs have to be sorted.
+std::vector<Polygons>           slice_mesh(
+    const MeshSlicingContext         &mesh,
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel = []{});
+
+std::vector<ExPolygons>         slice_mesh_ex(
+    const MeshSlicingContext         &mesh,
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel = []{});
+
 std::vector<float> get_mesh_overhang(
     const indexed_triangle_set& mesh,
     const std::vector<float>&   zs,
     const MeshSlicingParams&    params);
 
+std::vector<float> get_mesh_overhang(
+    const MeshSlicingContext&   mesh,
+    const std::vector<float>&   zs);
+
 // Slice a triangle set with a set of Z slabs (thick layers).
 // The effect is similar to producing the usual top / bottom layers from a sliced mesh by 
 // subtracting layer[i] from layer[i - 1] for the top surfaces resp.
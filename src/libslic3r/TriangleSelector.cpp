@@ -5,6 +5,11 @@
 #include <boost/container/small_vector.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <numeric>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
 #endif // NDEBUG
@@ -262,12 +267,7 @@ void TriangleSelector::select_patch(int facet_start, std::unique_ptr<Cursor> &&c
     std::vector<int> start_facets;
     HeightRange* hr_cursor = dynamic_cast<HeightRange*>(m_cursor.get());
     if (hr_cursor) {
-        for (int facet_id = 0; facet_id < m_orig_size_indices; facet_id++) {
-            const Triangle& tr = m_triangles[facet_id];
-            if (m_cursor->is_edge_inside_cursor(tr, m_vertices)) {
-                start_facets.push_back(facet_id);
-            }
-        }
+        this->facets_in_height_range(*hr_cursor, start_facets);
     }
     else {
         start_facets.push_back(facet_start);
@@ -546,6 +546,55 @@ void TriangleSelector::bucket_fill_select_triangles(const Vec3f& hit, int facet_
     }
 }
 
+void TriangleSelector::facets_in_height_range(const HeightRange &cursor, std::vector<int> &out) const
+{
+    FacetsZIndex &index  = m_facets_z_index;
+    const Vec3f   z_axis = cursor.trafo.linear().row(2).transpose();
+    if (index.facets.empty() || index.z_axis != z_axis) {
+        // (Re)build the index for the current transformation.
+        index.z_axis = z_axis;
+        index.facets.resize(m_orig_size_indices);
+        std::vector<std::pair<float, float>> z_span(m_orig_size_indices);
+        tbb::parallel_for(tbb::blocked_range<int>(0, m_orig_size_indices), [this, &z_axis, &z_span](const tbb::blocked_range<int> &range) {
+            for (int facet_id = range.begin(); facet_id < range.end(); ++ facet_id) {
+                const Triangle &tr = m_triangles[facet_id];
+                float z0 = z_axis.dot(m_vertices[tr.verts_idxs[0]].v);
+                float z1 = z_axis.dot(m_vertices[tr.verts_idxs[1]].v);
+                float z2 = z_axis.dot(m_vertices[tr.verts_idxs[2]].v);
+                z_span[facet_id] = { std::min(std::min(z0, z1), z2), std::max(std::max(z0, z1), z2) };
+            }
+        });
+        std::iota(index.facets.begin(), index.facets.end(), 0);
+        tbb::parallel_sort(index.facets.begin(), index.facets.end(), [&z_span](int l, int r) { return z_span[l].first < z_span[r].first || (z_span[l].first == z_span[r].first && l < r); });
+        index.z_min.resize(m_orig_size_indices);
+        index.z_max.resize(m_orig_size_indices);
+        index.max_height = 0.f;
+        float max_abs_z  = 0.f;
+        for (int i = 0; i < m_orig_size_indices; ++ i) {
+            const std::pair<float, float> &span = z_span[index.facets[i]];
+            index.z_min[i]   = span.first;
+            index.z_max[i]   = span.second;
+            index.max_height = std::max(index.max_height, span.second - span.first);
+            max_abs_z        = std::max(max_abs_z, std::max(std::abs(span.first), std::abs(span.second)));
+        }
+        // The index is only used to reject facets, the final test is done by the cursor itself.
+        // Make the bounds conservative to cover the rounding of the transformation applied by the cursor.
+        index.tolerance = 1e-4f * (max_abs_z + std::abs(cursor.trafo.translation().z())) + 1e-4f;
+    }
+
+    const float z_offset = cursor.trafo.translation().z();
+    const float bot_z    = cursor.z_world() - EPSILON - z_offset - index.tolerance;
+    const float top_z    = cursor.z_world() + cursor.height() + EPSILON - z_offset + index.tolerance;
+    // Facets touching the range start above bot_z - max_height.
+    auto begin = std::lower_bound(index.z_min.begin(), index.z_min.end(), bot_z - index.max_height);
+    auto end   = std::upper_bound(begin, index.z_min.end(), top_z);
+    out.clear();
+    for (size_t i = begin - index.z_min.begin(); i < size_t(end - index.z_min.begin()); ++ i)
+        if (index.z_max[i] >= bot_z && cursor.is_edge_inside_cursor(m_triangles[index.facets[i]], m_vertices))
+            out.emplace_back(index.facets[i]);
+    std::sort(out.begin(), out.end());
+}
+
 // Selects either the whole triangle (discarding any children it had), or divides
 // the triangle recursively, selecting just subtriangles truly inside the circle.
 // This is done by an actual recursive call. Returns false if the triangle is
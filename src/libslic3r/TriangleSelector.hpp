@@ -195,6 +195,8 @@ public:
         {
             return true;
         }
+        float z_world() const { return m_z_world; }
+        float height() const { return m_height; }
     private:
         float m_z_world;
         float m_height;
@@ -462,6 +464,25 @@ protected:
     // Zero indicates an uninitialized state.
     float m_old_cursor_radius_sqr = 0;
 
+    // Facets of the original mesh sorted by their minimum z after transformation by the HeightRange cursor,
+    // so that the facets touched by a height range are found without testing all the facets of the mesh.
+    // The transformation changes rarely (only if the object is rotated or scaled), the index is reused by all the cursor moves.
+    struct FacetsZIndex {
+        // Z row of the linear part of the transformation the index was built for. Translation is applied at query time.
+        Vec3f               z_axis { Vec3f::Zero() };
+        // Maximum z span of a facet.
+        float               max_height { 0.f };
+        // Tolerance of the z bounds stored in the index.
+        float               tolerance { 0.f };
+        // Minimum and maximum z of the facets, sorted by z_min.
+        std::vector<float>  z_min;
+        std::vector<float>  z_max;
+        std::vector<int>    facets;
+    };
+    mutable FacetsZIndex m_facets_z_index;
+    // Fill in facets of the original mesh touched by the HeightRange cursor in ascending order.
+    void facets_in_height_range(const HeightRange &cursor, std::vector<int> &out) const;
+
     // Private functions:
 private:
     bool select_triangle(int facet_idx, EnforcerBlockerType type, bool triangle_splitting);
@@ -344,7 +344,8 @@ void BackgroundSlicingProcess::process_sla()
 				ThumbnailsParams{ current_print()->full_print_config().option<ConfigOptionPoints>("thumbnails")->values, true, true, true, true, 0 });
 
             Zipper zipper(export_path);
-            m_sla_archive.export_print(zipper, *m_sla_print);																											         // true, false, true, true); // renders also supports and pad
+            m_sla_archive.export_print(zipper, *m_sla_print, "", m_sla_print->make_try_cancel(),
+                [this](int percent) { m_print->set_status(percent, _utf8(L("Rasterizing layers"))); });																											         // true, false, true, true); // renders also supports and pad
 			for (const ThumbnailData& data : thumbnails)
                 if (data.is_valid())
                     write_thumbnail(zipper, data);
@@ -1149,7 +1150,8 @@ void BackgroundSlicingProcess::prepare_upload()
         	ThumbnailsParams{current_print()->full_print_config().option<ConfigOptionPoints>("thumbnails")->values, true, true, true, true});
 																												 // true, false, true, true); // renders also supports and pad
         Zipper zipper{source_path.string()};
-        m_sla_archive.export_print(zipper, *m_sla_print, m_upload_job.upload_data.upload_path.string());
+        m_sla_archive.export_print(zipper, *m_sla_print, m_upload_job.upload_data.upload_path.string(), m_sla_print->make_try_cancel(),
+            [this](int percent) { m_print->set_status(percent, _utf8(L("Rasterizing layers"))); });
         for (const ThumbnailData& data : thumbnails)
 	        if (data.is_valid())
 	            write_thumbnail(zipper, data);
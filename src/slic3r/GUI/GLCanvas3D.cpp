@@ -2952,9 +2952,9 @@ void GLCanvas3D::reload_scene(bool refresh_immediately, bool force_full_scene_re
 #if ENABLE_SMOOTH_NORMALS
                                 volume.model.init_from(m_model->objects[volume.object_idx()]->volumes[volume.volume_idx()]->mesh(), true);
 #else
-                                const TriangleMesh& new_mesh = m_model->objects[volume.object_idx()]->volumes[volume.volume_idx()]->mesh();
-                                volume.model.init_from(new_mesh);
-                                volume.mesh_raycaster = std::make_shared<GUI::MeshRaycaster>(std::make_shared<TriangleMesh>(new_mesh));
+                                std::shared_ptr<const TriangleMesh> new_mesh = m_model->objects[volume.object_idx()]->volumes[volume.volume_idx()]->mesh_ptr();
+                                volume.model.init_from(*new_mesh);
+                                volume.mesh_raycaster = std::make_shared<GUI::MeshRaycaster>(new_mesh);
 #endif // ENABLE_SMOOTH_NORMALS
                             }
                         }
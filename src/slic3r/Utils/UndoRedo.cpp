@@ -8,6 +8,11 @@
 #include <cassert>
 #include <cstddef>
 
+#include <miniz.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <cereal/types/polymorphic.hpp>
 #include <cereal/types/map.hpp>
 #include <cereal/types/string.hpp>
@@ -54,6 +59,35 @@ static inline std::string ptr_to_string(const void* ptr)
 
 static std::string topmost_snapshot_name = "@@@ Topmost @@@";
 
+// Snapshot data smaller than this is not worth compressing.
+static constexpr size_t compress_min_size = 1024;
+
+// Compress the serialized snapshot data with the fastest miniz (deflate) setting.
+// Returns false if the data did not compress.
+static bool compress_snapshot_data(const std::string &src, std::string &dst)
+{
+	mz_ulong len = mz_compressBound(mz_ulong(src.size()));
+	dst.resize(len);
+	if (mz_compress2((unsigned char*)dst.data(), &len, (const unsigned char*)src.data(), mz_ulong(src.size()), MZ_BEST_SPEED) != MZ_OK || len >= src.size()) {
+		dst.clear();
+		dst.shrink_to_fit();
+		return false;
+	}
+	dst.resize(len);
+	dst.shrink_to_fit();
+	return true;
+}
+
+static std::string decompress_snapshot_data(const std::string &src, size_t size)
+{
+	std::string dst(size, 0);
+	mz_ulong len = mz_ulong(size);
+	int res = mz_uncompress((unsigned char*)dst.data(), &len, (const unsigned char*)src.data(), mz_ulong(src.size()));
+	if (res != MZ_OK || len != size)
+		throw Slic3r::RuntimeError("Undo / Redo stack: Failed to decompress a snapshot");
+	return dst;
+}
+
 bool Snapshot::is_topmost() const
 {
 	return this->name == topmost_snapshot_name;
@@ -120,6 +154,9 @@ public:
 	virtual size_t release_optional() = 0;
 	// Restore optional data possibly released by release_optional.
 	virtual void   restore_optional() = 0;
+	// Compress the data, which is not likely to be accessed soon. May be called from a worker thread,
+	// different histories may be compressed in parallel. Return the amount of memory released.
+	virtual size_t compress(StackImpl &stack) = 0;
 
 	// Estimated size in memory, to be used to drop least recently used snapshots.
 	virtual size_t memsize() const = 0;
@@ -312,6 +349,9 @@ public:
 			const_cast<T*>(m_shared_object.get())->restore_optional();
 	}
 
+	// Serialize and compress the object if it is referenced from the Undo / Redo stack only, release the shared pointer.
+	size_t compress(StackImpl &stack) override;
+
 	bool 						is_serialized() const { return m_shared_object.get() == nullptr; }
 	const std::string&			serialized_data() const { return m_serialized; }
 	std::shared_ptr<const T>& 	shared_ptr(StackImpl &stack);
@@ -338,7 +378,9 @@ private:
 	std::shared_ptr<const T>	m_shared_object;
 	// If this object is optional, then it may be deleted from the Undo / Redo stack and recalculated from other data (for example mesh convex hull).
 	bool 						m_optional;
+	// Compressed serialized object and its uncompressed size.
 	std::string 				m_serialized;
+	size_t 						m_serialized_size { 0 };
 };
 
 struct MutableHistoryInterval
@@ -349,26 +391,49 @@ private:
 		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
 		// with the associated cost of CPU cache invalidation on refcount change.
 		size_t		refcnt;
+		// Size of the serialized data before compression.
 		size_t		size;
-		char 		data[1];
+		// First 8 bytes of the serialized data (the timestamp for objects providing one), not compressed.
+		char 		head[8];
+		bool 		compressed;
+		// Serialized data, possibly compressed.
+		std::string data;
+
+		Data(std::string &&input_data) : refcnt(1), size(input_data.size()), compressed(false), data(std::move(input_data)) {
+			memset(this->head, 0, 8);
+			memcpy(this->head, this->data.data(), std::min<size_t>(this->size, 8));
+		}
+
+		std::string uncompressed() const { return this->compressed ? decompress_snapshot_data(this->data, this->size) : this->data; }
 
 		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
+		bool 		matches(const std::string& rhs) {
+			return this->size == rhs.size() && memcmp(this->head, rhs.data(), std::min<size_t>(this->size, 8)) == 0 &&
+				(this->compressed ? this->uncompressed() == rhs : this->data == rhs);
+		}
 
 		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
+		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->head, &timestamp, 8) == 0; }
+
+		// Compress the data in place, thus the compressed data is shared by all the intervals referencing this chunk.
+		size_t 		compress() {
+			if (this->compressed || this->size < compress_min_size)
+				return 0;
+			std::string out;
+			if (! compress_snapshot_data(this->data, out))
+				return 0;
+			size_t mem_released = this->data.size() - out.size();
+			this->data       = std::move(out);
+			this->compressed = true;
+			return mem_released;
+		}
 	};
 
 	Interval    m_interval;
 	Data	   *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
-	}
+	MutableHistoryInterval(const Interval &interval, std::string &&input_data) : m_interval(interval), m_data(new Data(std::move(input_data))) {}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
 		++ m_data->refcnt;
@@ -382,7 +447,7 @@ public:
 
 	~MutableHistoryInterval() {
 		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+			delete m_data;
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -396,17 +461,22 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
+	const char* data() const { return m_data->data.data(); }
 	size_t  	size() const { return m_data->size; }
 	size_t		refcnt() const { return m_data->refcnt; }
+	bool		is_compressed() const { return m_data->compressed; }
+	bool		shares_data(const MutableHistoryInterval &rhs) const { return m_data == rhs.m_data; }
+	// Uncompressed serialized data.
+	std::string load() const { return m_data->uncompressed(); }
 	bool		matches(const std::string& data) { return m_data->matches(data); }
 	bool		matches_timestamp(uint64_t timestamp) { return m_data->matches_timestamp(timestamp); }
+	size_t 		compress() { return m_data->compress(); }
 	size_t 		memsize() const {
 		return m_data->refcnt == 1 ?
 			// Count just the size of the snapshot data.
-			m_data->size :
+			m_data->data.size() :
 			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
+			(m_data->data.size() + m_data->refcnt - 1) / m_data->refcnt;
 	}
 
 private:
@@ -461,7 +531,7 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(size_t active_snapshot_time, size_t current_time, std::string &&data) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
 			if (! m_history.empty() && m_history.back().matches(data))
@@ -469,7 +539,7 @@ public:
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
 			else
 				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				m_history.emplace_back(Interval(current_time, current_time + 1), std::move(data));
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
@@ -478,7 +548,7 @@ public:
 				m_history.back().extend_end(current_time + 1);
 			else
 				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), std::move(data));
 		}
 	}
 
@@ -491,7 +561,7 @@ public:
 				--it;
 		}
 		//assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return it->load();
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -499,6 +569,16 @@ public:
 	// Currently there is no way to release optional data from the mutable objects.
 	void   restore_optional() override {}
 
+	// Compress all snapshots but the last one, which is compared against each newly taken snapshot.
+	size_t compress(StackImpl & /* stack */) override {
+		size_t mem_released = 0;
+		if (m_history.size() > 1)
+			for (auto it = m_history.begin(); it != m_history.end() - 1; ++ it)
+				if (! it->is_compressed() && ! it->shares_data(m_history.back()))
+					mem_released += it->compress();
+		return mem_released;
+	}
+
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	std::string format() override {
 		std::string out = typeid(T).name();
@@ -823,7 +903,7 @@ template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::share
 {
 	if (m_shared_object.get() == nullptr && ! m_serialized.empty()) {
 		// Deserialize the object.
-		std::istringstream iss(m_serialized);
+		std::istringstream iss(decompress_snapshot_data(m_serialized, m_serialized_size));
 		{
 			Slic3r::UndoRedo::InputArchive archive(stack, iss);
 			typedef typename std::remove_const<T>::type Type;
@@ -831,10 +911,36 @@ template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::share
 			archive(*mesh.get());
 			m_shared_object = std::move(mesh);
 		}
+		// The object is held by the shared pointer again, it will be compressed again by this->compress() once it is released by the scene.
+		m_serialized.clear();
+		m_serialized.shrink_to_fit();
+		m_serialized_size = 0;
 	}
 	return m_shared_object;
 }
 
+template<typename T> size_t ImmutableObjectHistory<T>::compress(StackImpl &stack)
+{
+	if (this->is_serialized() || m_shared_object.use_count() != 1)
+		return 0;
+	size_t memsize = m_shared_object->memsize();
+	if (memsize < compress_min_size)
+		return 0;
+	std::ostringstream oss;
+	{
+		Slic3r::UndoRedo::OutputArchive archive(stack, oss);
+		archive(*m_shared_object.get());
+	}
+	std::string data = oss.str();
+	std::string compressed;
+	if (! compress_snapshot_data(data, compressed) || compressed.size() >= memsize)
+		return 0;
+	m_serialized      = std::move(compressed);
+	m_serialized_size = data.size();
+	m_shared_object.reset();
+	return memsize - m_serialized.size();
+}
+
 template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 {
 	// First find or allocate a history stack for the ObjectID of this object instance.
@@ -902,7 +1008,12 @@ template<typename T> std::shared_ptr<const T> StackImpl::load_immutable_object(c
 	auto *object_history = static_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get());
 	assert(object_history->has_snapshot(m_active_snapshot_time));
 	object_history->restore_optional();
-	return object_history->shared_ptr(*this);
+	bool was_serialized = object_history->is_serialized();
+	std::shared_ptr<const T> &object = object_history->shared_ptr(*this);
+	if (was_serialized && object)
+		// The object was deserialized into a new instance, map its pointer back to the ObjectID of its history.
+		m_shared_ptr_to_object_id[(const void*)object.get()] = id;
+	return object;
 }
 
 template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID id, T &target)
@@ -1213,6 +1324,26 @@ void StackImpl::release_least_recently_used()
 		else
 			current_memsize = 0;
 	}
+	// Then compress the snapshot data, which is not likely to be accessed soon, before dropping the oldest snapshots.
+	// Meshes referenced by the Undo / Redo stack only are serialized and compressed as well. The histories are independent,
+	// thus they are compressed in parallel.
+	if (current_memsize > m_memory_limit) {
+		std::vector<std::pair<ObjectHistoryBase*, const void*>> histories;
+		histories.reserve(m_objects.size());
+		for (auto &kvp : m_objects)
+			histories.emplace_back(kvp.second.get(), kvp.second->immutable_object_ptr());
+		std::vector<size_t> mem_released(histories.size(), 0);
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, histories.size()), [this, &histories, &mem_released](const tbb::blocked_range<size_t> &range) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				mem_released[i] = histories[i].first->compress(*this);
+		});
+		for (size_t i = 0; i < histories.size(); ++ i) {
+			if (histories[i].second != nullptr && histories[i].first->immutable_object_ptr() == nullptr)
+				// The immutable object was serialized and released, its pointer may be reused by a newly allocated object.
+				m_shared_ptr_to_object_id.erase(histories[i].second);
+			current_memsize -= std::min(current_memsize, mem_released[i]);
+		}
+	}
 	while (current_memsize > m_memory_limit && m_snapshots.size() >= 3) {
 		// From which side to remove a snapshot?
 		assert(m_snapshots.front().timestamp < m_active_snapshot_time);
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/Smoothing.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +21,49 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+// Outer wall speeds of a single object smoothed by SmoothCalculator, either at once or in windows of layers
+// with the schedule of GCode::process_layers().
+static std::vector<float> smooth_outer_wall_speed(const std::vector<float> &feedrates, bool windowed)
+{
+    SmoothCalculator calculator(1);
+    int first_open_layer = 0;
+    for (size_t layer_id = 0; layer_id < feedrates.size();) {
+        size_t end = windowed ? std::min(feedrates.size(), layer_id + smoothing_lookahead_layers) : feedrates.size();
+        for (; layer_id < end; ++ layer_id) {
+            CoolingNode node;
+            node.outwall_line.emplace_back(0, 0);
+            node.max_feedrate    = feedrates[layer_id];
+            node.filter_feedrate = feedrates[layer_id];
+            OutwallCollection object_level;
+            object_level.object_id = 0;
+            object_level.cooling_nodes.emplace(0, node);
+            calculator.append_data(std::vector<OutwallCollection>{ object_level });
+        }
+        calculator.smooth_layer_speed(first_open_layer);
+        if (layer_id < feedrates.size())
+            first_open_layer = std::max(first_open_layer, calculator.layers_count() - smoothing_lookahead_layers);
+        calculator.release_layers(first_open_layer);
+    }
+    std::vector<float> out;
+    for (std::vector<OutwallCollection> &layer : calculator.layers_wall_collection)
+        out.emplace_back(layer.front().cooling_nodes[0].filter_feedrate);
+    return out;
+}
+
+TEST_CASE("Outer wall speed smoothing over a window of layers", "[GCode]") {
+    SECTION("Object lower than the window") {
+        std::vector<float> feedrates(smoothing_lookahead_layers - 10, 200.f);
+        feedrates[40] = 100.f;
+        REQUIRE(smooth_outer_wall_speed(feedrates, true) == smooth_outer_wall_speed(feedrates, false));
+    }
+    SECTION("Slow down propagated within the window") {
+        std::vector<float> feedrates(3 * smoothing_lookahead_layers, 200.f);
+        feedrates[2 * smoothing_lookahead_layers + 20] = 185.f;
+        std::vector<float> windowed = smooth_outer_wall_speed(feedrates, true);
+        std::vector<float> global   = smooth_outer_wall_speed(feedrates, false);
+        REQUIRE(windowed.size() == global.size());
+        for (size_t i = 0; i < windowed.size(); ++ i)
+            REQUIRE(windowed[i] == Approx(global[i]).margin(0.01));
+    }
+}
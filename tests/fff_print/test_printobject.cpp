@@ -87,3 +87,81 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: infill of a modified layer range", "[PrintObject]") {
+    GIVEN("20mm cube with ironed top surfaces and a layer range from 5mm to 10mm") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "layer_height",           0.2 },
+            { "first_layer_height",     0.2 },
+            { "sparse_infill_density",  "20%" },
+            { "ironing_type",           "top" }
+        });
+        const t_layer_height_range range { 5., 10. };
+        auto set_range_config = [&range](Slic3r::Model &model, double infill_anchor_max) {
+            ModelConfig &range_config = model.objects.front()->layer_config_ranges[range];
+            range_config.set_key_value("layer_height", new ConfigOptionFloat(0.2));
+            range_config.set_key_value("infill_anchor_max", new ConfigOptionFloatOrPercent(infill_anchor_max, false));
+        };
+        // Extrusions of the infill and ironing of each layer.
+        auto fills = [](const PrintObject &object) {
+            std::vector<std::vector<const ExtrusionEntity*>> out;
+            for (const Layer *layer : object.layers()) {
+                out.emplace_back();
+                for (const LayerRegion *region : layer->regions())
+                    out.back().insert(out.back().end(), region->fills.entities.begin(), region->fills.entities.end());
+            }
+            return out;
+        };
+        auto polylines = [](const std::vector<const ExtrusionEntity*> &entities) {
+            Polylines out;
+            for (const ExtrusionEntity *entity : entities)
+                entity->collect_polylines(out);
+            return out;
+        };
+
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        set_range_config(model, 20.);
+        print.apply(model, config);
+        print.process();
+        const PrintObject &object = *print.objects().front();
+        const std::vector<std::vector<const ExtrusionEntity*>> fills_before = fills(object);
+
+        WHEN("An infill option of the layer range is changed") {
+            set_range_config(model, 0.);
+            print.apply(model, config);
+            THEN("Just infill and the steps depending on it are invalidated") {
+                CHECK(object.is_step_done(posPrepareInfill));
+                CHECK(! object.is_step_done(posInfill));
+                CHECK(! object.is_step_done(posIroning));
+            }
+            print.process();
+            const std::vector<std::vector<const ExtrusionEntity*>> fills_after = fills(object);
+            REQUIRE(fills_after.size() == fills_before.size());
+            THEN("The infill and ironing outside of the layer range is kept") {
+                size_t num_kept = 0;
+                for (size_t i = 0; i < object.layers().size(); ++ i)
+                    if (const coordf_t z = object.get_layer(int(i))->slice_z; z < range.first - EPSILON || z > range.second + EPSILON) {
+                        CHECK(fills_after[i] == fills_before[i]);
+                        ++ num_kept;
+                    }
+                CHECK(num_kept > 0);
+                CHECK(num_kept < object.layers().size());
+            }
+            AND_THEN("The infill and ironing is the same as of the modified object sliced from scratch") {
+                Slic3r::Print print_fresh;
+                Slic3r::Model model_fresh;
+                Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print_fresh, model_fresh, config);
+                set_range_config(model_fresh, 0.);
+                print_fresh.apply(model_fresh, config);
+                print_fresh.process();
+                const std::vector<std::vector<const ExtrusionEntity*>> fills_fresh = fills(*print_fresh.objects().front());
+                REQUIRE(fills_fresh.size() == fills_after.size());
+                for (size_t i = 0; i < fills_after.size(); ++ i)
+                    CHECK(polylines(fills_after[i]) == polylines(fills_fresh[i]));
+            }
+        }
+    }
+}
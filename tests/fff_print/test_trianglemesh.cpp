@@ -2,6 +2,7 @@
 
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/MeshSlicesCache.hpp"
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Model.hpp"
@@ -301,6 +302,63 @@ SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
         }
     }
 }
+
+TEST_CASE("MeshSlicesCache shares slices of the same mesh and parameters", "[TriangleMeshSlicer]") {
+    auto mesh = std::make_shared<const TriangleMesh>(make_cube());
+    std::vector<float> zs { 1.f, 5.f, 10.f };
+    MeshSlicingParamsEx params;
+    std::vector<ExPolygons> slices = slice_mesh_ex(mesh->its, zs, params);
+    MeshSlicesCache &cache = MeshSlicesCache::instance();
+    cache.clear();
+    std::vector<ExPolygons> cached;
+    REQUIRE(! cache.find(mesh, zs, params, cached));
+    cache.store(mesh, zs, params, slices);
+    REQUIRE(cache.find(mesh, zs, params, cached));
+    REQUIRE(cached == slices);
+    MeshSlicingParamsEx params_rotated { params };
+    params_rotated.trafo.rotate(Eigen::AngleAxisd(0.5, Vec3d::UnitZ()));
+    REQUIRE(! cache.find(mesh, zs, params_rotated, cached));
+    REQUIRE(! cache.find(mesh, { 1.f, 5.f }, params, cached));
+    auto copy = std::make_shared<const TriangleMesh>(*mesh);
+    REQUIRE(! cache.find(copy, zs, params, cached));
+    mesh.reset();
+    cache.store(copy, zs, params, slices);
+    REQUIRE(cache.memsize() > 0);
+    cache.set_memory_limit(0);
+    REQUIRE(cache.memsize() == 0);
+    cache.set_memory_limit(256 * 1024 * 1024);
+}
+
+TEST_CASE("MeshSlicingContext slices the same as a single plane", "[TriangleMeshSlicer]") {
+    TriangleMesh mesh = make_sphere(10., 2. * PI / 40.);
+    Transform3d  trafo = Transform3d::Identity();
+    trafo.rotate(Eigen::AngleAxisd(0.3, Vec3d::UnitX()));
+    std::vector<float> zs;
+    for (float z = -9.9f; z < 10.f; z += 0.3f)
+        zs.emplace_back(z);
+    MeshSlicingContext context(mesh.its, trafo);
+    MeshSlicingParams  params;
+    params.trafo = trafo;
+    // Slicing a single plane does not use a context, it slices each facet of the mesh.
+    auto check_single_planes = [&mesh, &context, &params](const std::vector<float> &zs) {
+        std::vector<Polygons> layers = slice_mesh(context, zs, params);
+        REQUIRE(layers.size() == zs.size());
+        for (size_t i = 0; i < zs.size(); ++ i) {
+            Polygons single = slice_mesh(mesh.its, zs[i], params);
+            REQUIRE(layers[i].size() == single.size());
+            REQUIRE(std::abs(area(layers[i]) - area(single)) < 1e-3 * std::abs(area(single)) + 1.);
+        }
+    };
+    check_single_planes(zs);
+    // Slicing again with the same context at other zs.
+    check_single_planes({ -5.f, 0.f, 5.f });
+    // The facets crossing a single plane are not swept, they are collected by a linear search over the facets.
+    std::vector<float> overhang = get_mesh_overhang(context, zs);
+    REQUIRE(overhang.size() == zs.size());
+    for (size_t i = 0; i < zs.size(); ++ i)
+        REQUIRE(overhang[i] == Approx(get_mesh_overhang(mesh.its, { zs[i] }, params).front()).margin(1e-5));
+}
+
 #ifdef TEST_PERFORMANCE
 TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
     TriangleMesh mesh;
@@ -3,6 +3,7 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeCache.hpp>
 
 using namespace Slic3r;
 
@@ -58,3 +59,136 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Sharing a tree over a large mesh through AABBTreeCache", "[AABBIndirect]")
+{
+    // Large enough for the subtrees to be built in parallel.
+    auto mesh = std::make_shared<const TriangleMesh>(make_sphere(10., 2. * PI / 360.));
+    REQUIRE(mesh->its.indices.size() > 100000);
+
+    std::shared_ptr<const AABBTreeCache::Tree> tree = AABBTreeCache::instance().get(mesh);
+    REQUIRE(tree);
+    REQUIRE(! tree->empty());
+    REQUIRE(AABBTreeCache::instance().get(mesh) == tree);
+
+    igl::Hit hit;
+    bool intersected = AABBTreeIndirect::intersect_ray_first_hit(
+        mesh->its.vertices, mesh->its.indices, *tree, Vec3d(0.1, 0.2, -50.), Vec3d(0., 0., 1.), hit);
+    REQUIRE(intersected);
+    REQUIRE(hit.t == Approx(40.).margin(0.01));
+
+    size_t hit_idx;
+    Vec3d  closest_point;
+    double squared_distance = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(
+        mesh->its.vertices, mesh->its.indices, *tree, Vec3d(30., 0., 0.), hit_idx, closest_point);
+    REQUIRE(std::sqrt(squared_distance) == Approx(20.).margin(0.01));
+
+    // A copy of the mesh is another mesh.
+    auto copy = std::make_shared<const TriangleMesh>(*mesh);
+    REQUIRE(AABBTreeCache::instance().get(copy) != tree);
+
+    // The cache does not keep the tree alive.
+    std::weak_ptr<const AABBTreeCache::Tree> weak_tree = tree;
+    tree.reset();
+    REQUIRE(weak_tree.expired());
+}
+
+TEST_CASE("Tracing ray packets matches tracing single rays", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_sphere(1., 2. * PI / 90.);
+    // Add a second sphere, so that some of the rays shot from the first one are occluded.
+    TriangleMesh tmesh2 = tmesh;
+    tmesh2.translate(3.f, 0.f, 0.f);
+    tmesh.merge(tmesh2);
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+
+    // Rays shot into a hemisphere from points above the surface of the first sphere, the count is not divisible by the packet size.
+    std::vector<Vec3f> origins;
+    std::vector<Vec3f> dirs;
+    for (size_t i = 0; i < 301; ++ i) {
+        Vec3f normal = Vec3f(std::cos(0.1 * i), std::sin(0.1 * i), std::cos(0.37 * i)).normalized();
+        Vec3f dir    = (normal + Vec3f(std::cos(0.7 * i), std::sin(1.3 * i), std::sin(0.3 * i)).normalized()).normalized();
+        origins.emplace_back(normal * 1.01f);
+        dirs.emplace_back(dir);
+    }
+
+    std::vector<igl::Hit> hits4, hits8, hits_default;
+    AABBTreeIndirect::intersect_rays_first_hit<4>(tmesh.its.vertices, tmesh.its.indices, tree, origins, dirs, hits4);
+    AABBTreeIndirect::intersect_rays_first_hit<8>(tmesh.its.vertices, tmesh.its.indices, tree, origins, dirs, hits8);
+    AABBTreeIndirect::intersect_rays_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origins, dirs, hits_default);
+    REQUIRE(hits4.size() == origins.size());
+    REQUIRE(hits8.size() == origins.size());
+    REQUIRE(hits_default.size() == origins.size());
+
+    size_t num_hits = 0;
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        igl::Hit hit;
+        bool intersected = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree,
+            Vec3d(origins[i].cast<double>()), Vec3d(dirs[i].cast<double>()), hit);
+        REQUIRE((hits4[i].id >= 0) == intersected);
+        REQUIRE((hits8[i].id >= 0) == intersected);
+        REQUIRE((hits_default[i].id >= 0) == intersected);
+        if (intersected) {
+            ++ num_hits;
+            REQUIRE(hits4[i].t == Approx(hit.t));
+            REQUIRE(hits8[i].t == Approx(hit.t));
+            REQUIRE(hits_default[i].t == Approx(hit.t));
+        }
+    }
+    REQUIRE(num_hits > 0);
+    REQUIRE(num_hits < origins.size());
+}
+
+TEST_CASE("Queries over a WideTree match the binary tree", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_sphere(1., 2. * PI / 90.);
+    TriangleMesh tmesh2 = tmesh;
+    tmesh2.translate(3.f, 0.f, 0.f);
+    tmesh.merge(tmesh2);
+    auto tree  = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    auto tree4 = AABBTreeIndirect::build_wide_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    auto tree8 = AABBTreeIndirect::build_wide_aabb_tree_over_indexed_triangle_set<8>(tmesh.its.vertices, tmesh.its.indices);
+    REQUIRE(! tree4.empty());
+    REQUIRE(! tree8.empty());
+    REQUIRE(tree4.nodes().size() < tree.nodes().size());
+
+    auto check = [&tmesh, &tree](const auto &wide_tree) {
+        for (size_t i = 0; i < 200; ++ i) {
+            Vec3d origin(-3. + 0.045 * i, std::sin(0.3 * i), 5.);
+            Vec3d dir = (Vec3d(0.01 * i, 0.5 * std::cos(0.7 * i), -1.)).normalized();
+
+            igl::Hit hit, wide_hit;
+            bool intersected = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origin, dir, hit);
+            REQUIRE(AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, wide_tree, origin, dir, wide_hit) == intersected);
+            if (intersected)
+                REQUIRE(wide_hit.t == Approx(hit.t));
+
+            std::vector<igl::Hit> hits, wide_hits;
+            AABBTreeIndirect::intersect_ray_all_hits(tmesh.its.vertices, tmesh.its.indices, tree, origin, dir, hits);
+            AABBTreeIndirect::intersect_ray_all_hits(tmesh.its.vertices, tmesh.its.indices, wide_tree, origin, dir, wide_hits);
+            REQUIRE(wide_hits.size() == hits.size());
+            for (size_t j = 0; j < hits.size(); ++ j)
+                REQUIRE(wide_hits[j].t == Approx(hits[j].t));
+
+            size_t hit_idx, wide_hit_idx;
+            Vec3d  closest_point, wide_closest_point;
+            double squared_distance = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(
+                tmesh.its.vertices, tmesh.its.indices, tree, origin, hit_idx, closest_point);
+            double wide_squared_distance = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(
+                tmesh.its.vertices, tmesh.its.indices, wide_tree, origin, wide_hit_idx, wide_closest_point);
+            REQUIRE(wide_squared_distance == Approx(squared_distance));
+            REQUIRE((wide_closest_point - closest_point).norm() < EPSILON);
+
+            Vec3f point = tmesh.its.vertices[(i * 37) % tmesh.its.vertices.size()];
+            std::vector<size_t> candidates, wide_candidates;
+            AABBTreeIndirect::get_candidate_idxs(tree, point, candidates);
+            AABBTreeIndirect::get_candidate_idxs(wide_tree, point, wide_candidates);
+            std::sort(candidates.begin(), candidates.end());
+            std::sort(wide_candidates.begin(), wide_candidates.end());
+            REQUIRE(! wide_candidates.empty());
+            REQUIRE(wide_candidates == candidates);
+        }
+    };
+    check(tree4);
+    check(tree8);
+}
@@ -299,3 +299,57 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Batched clipping of subjects by a common clip", "[ClipperUtils]") {
+    auto circle = [](const Point &center, coord_t radius, size_t num_points) {
+        Polygon out;
+        for (size_t i = 0; i < num_points; ++ i) {
+            double angle = 2. * PI * double(i) / double(num_points);
+            out.points.emplace_back(center + Point(radius * cos(angle), radius * sin(angle)));
+        }
+        return out;
+    };
+    // A grid of squares with holes, some inside, some outside and some crossing the clip.
+    ExPolygons subjects;
+    for (int i = 0; i < 6; ++ i)
+        for (int j = 0; j < 6; ++ j) {
+            Polygon square { { 0, 0 }, { scaled(8.), 0 }, { scaled(8.), scaled(8.) }, { 0, scaled(8.) } };
+            square.translate(scaled(10. * i), scaled(10. * j));
+            Polygon hole = circle(square.centroid(), scaled(2.), 16);
+            hole.reverse();
+            subjects.emplace_back(std::move(square), std::move(hole));
+        }
+    // A subject with more edges than a reused Clipper keeps for the next subject.
+    subjects.emplace_back(circle(Point(scaled(25.), scaled(25.)), scaled(20.), 20000));
+    Polygons clip { circle(Point(scaled(15.), scaled(15.)), scaled(13.), 200), circle(Point(scaled(50.), scaled(40.)), scaled(7.), 100) };
+    clip.push_back({ { scaled(-5.), scaled(31.) }, { scaled(65.), scaled(33.) }, { scaled(65.), scaled(36.) }, { scaled(-5.), scaled(34.) } });
+
+    // The batched results may start their contours at other points, thus they are compared by their symmetric difference.
+    auto check_same = [](const std::vector<ExPolygons> &batched, const std::vector<ExPolygons> &expected) {
+        REQUIRE(batched.size() == expected.size());
+        for (size_t i = 0; i < batched.size(); ++ i) {
+            CHECK(area(batched[i]) == Approx(area(expected[i])));
+            CHECK(area(diff_ex(batched[i], expected[i])) < scaled(0.01) * scaled(0.01));
+            CHECK(area(diff_ex(expected[i], batched[i])) < scaled(0.01) * scaled(0.01));
+        }
+    };
+    std::vector<ExPolygons> expected_diff, expected_intersection;
+    for (const ExPolygon &subject : subjects) {
+        expected_diff.emplace_back(diff_ex(subject, clip));
+        expected_intersection.emplace_back(intersection_ex(subject, clip));
+    }
+    REQUIRE(std::count_if(expected_diff.begin(), expected_diff.end(), [](const ExPolygons &e) { return e.empty(); }) > 0);
+    REQUIRE(std::count_if(expected_intersection.begin(), expected_intersection.end(), [](const ExPolygons &e) { return e.empty(); }) > 0);
+
+    SECTION("ExPolygons") {
+        check_same(diff_ex_batch(subjects, clip), expected_diff);
+        check_same(intersection_ex_batch(subjects, clip), expected_intersection);
+    }
+    SECTION("Surfaces") {
+        Surfaces surfaces;
+        for (const ExPolygon &subject : subjects)
+            surfaces.emplace_back(stInternal, subject);
+        check_same(diff_ex_batch(surfaces, clip), expected_diff);
+        check_same(intersection_ex_batch(surfaces, clip), expected_intersection);
+    }
+}
@@ -237,3 +237,31 @@ SCENARIO("DynamicPrintConfig serialization", "[Config]") {
         }
     }
 }
+
+SCENARIO("DynamicConfig merge and diff keep options sorted by key", "[Config]") {
+    GIVEN("Two partially overlapping configs") {
+        DynamicPrintConfig a;
+        a.set_key_value("wall_loops", new ConfigOptionInt(2));
+        a.set_key_value("layer_height", new ConfigOptionFloat(0.2));
+        DynamicPrintConfig b;
+        b.set_key_value("sparse_infill_density", new ConfigOptionPercent(15));
+        b.set_key_value("layer_height", new ConfigOptionFloat(0.3));
+        b.set_key_value("bottom_shell_layers", new ConfigOptionInt(3));
+        WHEN("The configs are diffed") {
+            THEN("Only the common option with a different value is reported") {
+                REQUIRE(a.diff(b) == t_config_option_keys{ "layer_height" });
+                REQUIRE(a.equal(b).empty());
+                REQUIRE(! a.equals(b));
+            }
+        }
+        WHEN("One config is merged into the other") {
+            a += b;
+            THEN("Missing options are added, common options are overwritten and keys stay sorted") {
+                REQUIRE(a.keys() == t_config_option_keys{ "bottom_shell_layers", "layer_height", "sparse_infill_density", "wall_loops" });
+                REQUIRE(a.opt_float("layer_height") == Approx(0.3));
+                REQUIRE(a.opt_int("wall_loops") == 2);
+                REQUIRE(a.equals(b));
+            }
+        }
+    }
+}
@@ -282,6 +282,49 @@ TEST_CASE("Simplify mesh by Quadric edge collapse to 5%", "[its]")
     CHECK(is_similar(its, mesh.its, cfg));
 }
 
+TEST_CASE("Simplify mesh by partitioned Quadric edge collapse to 5%", "[its]")
+{
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    double original_volume = its_volume(mesh.its);
+    uint32_t wanted_count = mesh.its.indices.size() * 0.05;
+    REQUIRE_FALSE(mesh.empty());
+    indexed_triangle_set its = mesh.its; // copy
+    float max_error = std::numeric_limits<float>::max();
+    its_quadric_edge_collapse_partitioned(its, 4, wanted_count, &max_error);
+    CHECK(its.indices.size() <= wanted_count);
+    double volume = its_volume(its);
+    CHECK(fabs(original_volume - volume) < 33.);
+
+    // seams between the parts are simplified by a final serial pass,
+    // the result is close to the serial simplification
+    CompareConfig cfg;
+    cfg.max_average_distance = 0.045f;
+    cfg.max_distance         = 0.4f;
+
+    CHECK(is_similar(mesh.its, its, cfg));
+    CHECK(is_similar(its, mesh.its, cfg));
+}
+
+TEST_CASE("Simplify mesh by partitioned Quadric edge collapse to 70%", "[its]")
+{
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    uint32_t wanted_count = mesh.its.indices.size() * 0.7;
+    REQUIRE_FALSE(mesh.empty());
+    indexed_triangle_set its = mesh.its; // copy
+    float max_error = std::numeric_limits<float>::max();
+    // the parts are not reduced at all, only the final pass simplifies the mesh
+    its_quadric_edge_collapse_partitioned(its, 4, wanted_count, &max_error);
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(its.indices.size() + 2 >= wanted_count);
+
+    CompareConfig cfg;
+    cfg.max_average_distance = 0.01f;
+    cfg.max_distance         = 0.1f;
+
+    CHECK(is_similar(mesh.its, its, cfg));
+    CHECK(is_similar(its, mesh.its, cfg));
+}
+
 bool exist_triangle_with_twice_vertices(const std::vector<stl_triangle_vertex_indices>& indices)
 {
     for (const auto &face : indices)
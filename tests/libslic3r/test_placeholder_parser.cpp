@@ -33,6 +33,12 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     SECTION("nested config options (legacy syntax)") { REQUIRE(parser.process("[temperature_[foo]]") == "357"); }
     SECTION("array reference") { REQUIRE(parser.process("{temperature[foo]}") == "357"); }
     SECTION("whitespaces and newlines are maintained") { REQUIRE(parser.process("test [ temperature_ [foo] ] \n hu") == "test 357 \n hu"); }
+    SECTION("text around macros is maintained") { REQUIRE(parser.process(" M104 S{temperature[bar]} ; }\n{if bar == 2}G1 [bar]{else}G0{endif} }") == "M104 S363 ; }\nG1 2 }"); }
+    SECTION("repeated processing of the same template") {
+        const std::string templ = "M104 S[temperature_[foo]] {\"}\" + \"{\"} T{bar}";
+        REQUIRE(parser.process(templ) == "M104 S357 }{ T2");
+        REQUIRE(parser.process(templ) == "M104 S357 }{ T2");
+    }
 
     // Test the math expressions.
     SECTION("math: 2*3") { REQUIRE(parser.process("{2*3}") == "6"); }
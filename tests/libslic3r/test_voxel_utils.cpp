@@ -0,0 +1,130 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <set>
+
+#include <libslic3r/Interlocking/VoxelUtils.hpp>
+
+using namespace Slic3r;
+
+namespace {
+
+struct GridPointLess
+{
+    bool operator()(const GridPoint3 &l, const GridPoint3 &r) const
+    {
+        return l.z() < r.z() || (l.z() == r.z() && (l.y() < r.y() || (l.y() == r.y() && l.x() < r.x())));
+    }
+};
+using CellSet = std::set<GridPoint3, GridPointLess>;
+
+CellSet to_set(const VoxelGrid &grid)
+{
+    CellSet out;
+    grid.for_each([&out](const GridPoint3 &cell) { out.insert(cell); });
+    return out;
+}
+
+VoxelGrid to_grid(const CellSet &cells, const GridPoint3 &min, const GridPoint3 &max)
+{
+    VoxelGrid out(min, max);
+    for (const GridPoint3 &cell : cells)
+        out.set(cell);
+    return out;
+}
+
+// Dilation by hashing each kernel offset of each cell, as the interlocking generator did before VoxelGrid.
+CellSet dilated(const CellSet &cells, const DilationKernel &kernel, const VoxelGrid &bounds)
+{
+    CellSet out;
+    for (const GridPoint3 &cell : cells)
+        for (const GridPoint3 &rel : kernel.relative_cells_)
+            if (bounds.contains(cell + rel))
+                out.insert(cell + rel);
+    return out;
+}
+
+CellSet random_cells(std::mt19937 &rng, const GridPoint3 &min, const GridPoint3 &max, size_t count)
+{
+    std::uniform_int_distribution<coord_t> x(min.x(), max.x()), y(min.y(), max.y()), z(min.z(), max.z());
+    CellSet out;
+    for (size_t i = 0; i < count; ++ i)
+        out.insert(GridPoint3(x(rng), y(rng), z(rng)));
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("VoxelGrid boolean operations match sets of cells", "[VoxelUtils]")
+{
+    std::mt19937 rng(3);
+    // More than two words per row, the last one partially used.
+    const GridPoint3 min(-70, -5, -2), max(90, 7, 9);
+    const CellSet    a = random_cells(rng, min, max, 600);
+    const CellSet    b = random_cells(rng, min, max, 600);
+
+    CellSet a_or_b = a, a_and_b, a_minus_b;
+    a_or_b.insert(b.begin(), b.end());
+    for (const GridPoint3 &cell : a)
+        (b.count(cell) ? a_and_b : a_minus_b).insert(cell);
+
+    REQUIRE(to_set(to_grid(a, min, max)) == a);
+    CHECK(to_set(to_grid(a, min, max) |= to_grid(b, min, max)) == a_or_b);
+    CHECK(to_set(to_grid(a, min, max) &= to_grid(b, min, max)) == a_and_b);
+    CHECK(to_set(to_grid(a, min, max).subtract(to_grid(b, min, max))) == a_minus_b);
+
+    VoxelGrid above_zero = to_grid(a, min, max);
+    above_zero.clear_below(0);
+    CellSet a_above_zero;
+    for (const GridPoint3 &cell : a)
+        if (cell.z() >= 0)
+            a_above_zero.insert(cell);
+    CHECK(to_set(above_zero) == a_above_zero);
+    CHECK(! to_grid(a, min, max).empty());
+    CHECK(VoxelGrid(min, max).empty());
+}
+
+TEST_CASE("VoxelGrid dilation matches dilating each cell", "[VoxelUtils]")
+{
+    std::mt19937 rng(7);
+    const GridPoint3 min(-3, -4, 0), max(130, 11, 8);
+    const CellSet    cells = random_cells(rng, min, max, 150);
+    const VoxelGrid  grid  = to_grid(cells, min, max);
+
+    for (DilationKernel::Type type : { DilationKernel::Type::CUBE, DilationKernel::Type::DIAMOND, DilationKernel::Type::PRISM })
+        for (const GridPoint3 &size : { GridPoint3(1, 1, 1), GridPoint3(3, 3, 3), GridPoint3(4, 2, 5), GridPoint3(67, 3, 2) }) {
+            const DilationKernel kernel(size, type);
+            CAPTURE(int(type), size.x(), size.y(), size.z());
+            CHECK(to_set(grid.dilated(kernel)) == dilated(cells, kernel, grid));
+        }
+}
+
+TEST_CASE("Kernel aligned walks dilated by VoxelGrid match the dilated walks", "[VoxelUtils]")
+{
+    const VoxelUtils     vu(Vec3crd(scaled(0.8), scaled(0.8), 2));
+    const DilationKernel kernel(GridPoint3(3, 3, 2), DilationKernel::Type::PRISM);
+    const GridPoint3     min(-10, -10, -2), max(40, 40, 6);
+    const ExPolygon      expoly({ { 0, 0 }, { scaled(20.), 0 }, { scaled(24.), scaled(12.) }, { scaled(3.), scaled(17.) } });
+
+    auto check = [&](auto walk_aligned, auto walk_dilated) {
+        CellSet aligned, expected;
+        walk_aligned(vu, expoly, 1, kernel, [&aligned](GridPoint3 cell) { aligned.insert(cell); return true; });
+        REQUIRE(! aligned.empty());
+        VoxelGrid grid = to_grid(aligned, min, max);
+        walk_dilated(vu, expoly, 1, kernel, [&expected, &grid](GridPoint3 cell) {
+            if (grid.contains(cell))
+                expected.insert(cell);
+            return true;
+        });
+        CHECK(to_set(grid.dilated(kernel)) == expected);
+    };
+
+    SECTION("Polygons") {
+        check([](const VoxelUtils &vu, auto&&... args) { return vu.walkKernelAlignedPolygons(args...); },
+              [](const VoxelUtils &vu, auto&&... args) { return vu.walkDilatedPolygons(args...); });
+    }
+    SECTION("Areas") {
+        check([](const VoxelUtils &vu, auto&&... args) { return vu.walkKernelAlignedAreas(args...); },
+              [](const VoxelUtils &vu, auto&&... args) { return vu.walkDilatedAreas(args...); });
+    }
+}